@@ -110,6 +110,22 @@
         <source>SLD incoherent 1/cm^2</source>
         <translation>inkohärente Streulängendichte (1/cm²)</translation>
     </message>
+    <message>
+        <source>absorption cross section 1/cm</source>
+        <translation>makroskopischer Absorptions-Querschnitt (1/cm)</translation>
+    </message>
+    <message>
+        <source>incoherent cross section 1/cm</source>
+        <translation>makroskopischer inkohärenter Streu-Querschnitt (1/cm)</translation>
+    </message>
+    <message>
+        <source>total cross section 1/cm</source>
+        <translation>makroskopischer totaler Querschnitt (1/cm)</translation>
+    </message>
+    <message>
+        <source>transmission of 1 mm</source>
+        <translation>Transmission bei 1 mm Dicke</translation>
+    </message>
     <message>
         <location filename="../../src/mainwindow.cpp" line="140"/>
         <source>&amp;File</source>
@@ -304,9 +320,9 @@
         <translation>f&apos;&apos;</translation>
     </message>
     <message>
-        <location filename="../../src/mainwindow.ui" line="137"/>
-        <source>Not used at the moment.</source>
-        <translation>Momentan nicht verwendet.</translation>
+        <location filename="../../src/mainwindow.ui" line="124"/>
+        <source>Neutron wavelength for absorption and transmission.</source>
+        <translation>Neutronen-Wellenlänge für Absorption und Transmission.</translation>
     </message>
     <message>
         <location filename="../../src/mainwindow.ui" line="228"/>
@@ -110,6 +110,22 @@
         <source>SLD incoherent 1/cm^2</source>
         <translation>Incoherent Scattering Length Density (1/cm²)</translation>
     </message>
+    <message>
+        <source>absorption cross section 1/cm</source>
+        <translation>Macroscopic Absorption Cross Section (1/cm)</translation>
+    </message>
+    <message>
+        <source>incoherent cross section 1/cm</source>
+        <translation>Macroscopic Incoherent Cross Section (1/cm)</translation>
+    </message>
+    <message>
+        <source>total cross section 1/cm</source>
+        <translation>Macroscopic Total Cross Section (1/cm)</translation>
+    </message>
+    <message>
+        <source>transmission of 1 mm</source>
+        <translation>Transmission of 1 mm</translation>
+    </message>
     <message>
         <location filename="../../src/mainwindow.cpp" line="140"/>
         <source>&amp;File</source>
@@ -304,9 +320,9 @@
         <translation>f&apos;&apos;</translation>
     </message>
     <message>
-        <location filename="../../src/mainwindow.ui" line="137"/>
-        <source>Not used at the moment.</source>
-        <translation>Not used at the moment.</translation>
+        <location filename="../../src/mainwindow.ui" line="124"/>
+        <source>Neutron wavelength for absorption and transmission.</source>
+        <translation>Neutron wavelength for absorption and transmission.</translation>
     </message>
     <message>
         <location filename="../../src/mainwindow.ui" line="228"/>
@@ -0,0 +1,188 @@
+/*
+ * src/batchcalculator.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include "batchcalculator.h"
+
+BatchResult::BatchResult()
+	: status(OK), electrons(0.0), mass(0.0), volume(0.0),
+	  xrayStatus(XraySpan::NO_DATA)
+{
+}
+
+RowCalculator::RowCalculator(const ElementDatabase& db)
+	: mInputData(db)
+{
+}
+
+void 
+RowCalculator::calculate(const BatchInput& in, BatchResult& out)
+{
+	process(in, 0.0, 0.0, 0, out);
+}
+
+void 
+RowCalculator::calculate(const BatchInput&  in, 
+                         double             exchangeable,
+                         double             deuterable,
+                         DeuterationSeries& series,
+                         BatchResult&       out)
+{
+	process(in, exchangeable, deuterable, &series, out);
+}
+
+void 
+RowCalculator::process(const BatchInput&   in, 
+                       double              exchangeable,
+                       double              deuterable,
+                       DeuterationSeries * series,
+                       BatchResult&        out)
+{
+	out.status = BatchResult::OK;
+	out.error.clear();
+	try {
+		mResult.density = in.density;
+		mResult.xrayEnergy = in.xrayEnergy;
+		mResult.neutronWavelength = in.neutronWavelength;
+		if (!series) {
+			mInputData.calculate(in.formula, mResult);
+		} else if (!mInputData.calcDeuteration(in.formula, exchangeable, 
+		                                       deuterable, mResult, *series))
+		{
+			out.status = BatchResult::INVALID_INPUT;
+			out.error = "not enough hydrogen for contrast variation";
+		}
+	} catch(const ErrorUnknownElement& e) {
+		size_t start, length;
+		out.status = BatchResult::UNKNOWN_ELEMENT;
+		out.error = e.what(start, length);
+		mResult.clear();
+	} catch(const cfp::Error& e) {
+		size_t start, length;
+		out.status = BatchResult::PARSE_ERROR;
+		out.error = e.what(start, length);
+		mResult.clear();
+	}
+	out.electrons = mResult.electrons;
+	out.mass = mResult.mass;
+	out.volume = mResult.volume;
+	out.sldCoherent = mResult.sldCoherent;
+	out.sldIncoherent = mResult.sldIncoherent;
+	out.xrayStatus = mResult.xrayStatus;
+	out.sldXray = mResult.sldXray;
+}
+
+void 
+RowCalculator::setResultCache(ResultCache * cache)
+{
+	mInputData.setResultCache(cache);
+}
+
+/// Processes chunks of rows until there are none left.
+class BatchCalculator::Worker: public QRunnable
+{
+public:
+	Worker(const ElementDatabase&         db,
+	       const std::vector<BatchInput>& input,
+	       std::vector<BatchResult>&      output,
+	       QAtomicInt&                    nextChunk,
+	       int                            chunkSize,
+	       ResultCache *                  cache)
+		: mCalculator(db), mInput(input), mOutput(output),
+		  mNextChunk(nextChunk), mChunkSize(chunkSize)
+	{
+		mCalculator.setResultCache(cache);
+	}
+
+	void run();
+private:
+	RowCalculator                  mCalculator;
+	const std::vector<BatchInput>& mInput;
+	std::vector<BatchResult>&      mOutput;
+	QAtomicInt&                    mNextChunk; //!< Shared by all workers.
+	int                            mChunkSize;
+};
+
+void 
+BatchCalculator::Worker::run()
+{
+	int rowCount = int(mInput.size());
+	for (;;) 
+	{
+		int begin = mNextChunk.fetchAndAddOrdered(1) * mChunkSize;
+		if (begin >= rowCount) break;
+		int end = std::min(begin + mChunkSize, rowCount);
+		for (int i = begin; i < end; i++) {
+			mCalculator.calculate(mInput[i], mOutput[i]);
+		}
+	}
+}
+
+BatchCalculator::BatchCalculator(const ElementDatabase& db)
+	: mDB(db), 
+	  mChunkSize(256),
+	  mThreadCount(QThread::idealThreadCount()),
+	  mCache(0)
+{
+}
+
+void 
+BatchCalculator::setChunkSize(int rows)
+{
+	mChunkSize = std::max(1, rows);
+}
+
+void 
+BatchCalculator::setThreadCount(int threads)
+{
+	mThreadCount = threads;
+}
+
+void 
+BatchCalculator::setResultCache(ResultCache * cache)
+{
+	mCache = cache;
+}
+
+void 
+BatchCalculator::run(const std::vector<BatchInput>& input, 
+                     std::vector<BatchResult>&      output) const
+{
+	output.resize(input.size());
+	if (input.empty()) return;
+
+	int chunkCount = (int(input.size()) + mChunkSize - 1) / mChunkSize;
+	int threads = std::min(std::max(1, mThreadCount), chunkCount);
+	QAtomicInt nextChunk(0);
+	QThreadPool pool;
+	pool.setMaxThreadCount(threads);
+	for (int i = 0; i < threads; i++) {
+		pool.start(new Worker(mDB, input, output, nextChunk, mChunkSize, 
+		                      mCache));
+	}
+	pool.waitForDone();
+}
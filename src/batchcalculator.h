@@ -0,0 +1,158 @@
+/*
+ * src/batchcalculator.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCH_CALCULATOR_H
+#define BATCH_CALCULATOR_H
+
+#include <string>
+#include <vector>
+#include <QByteArray>
+#include "calcresult.h"
+#include "inputdata.h"
+
+/// A single row of input for the BatchCalculator.
+struct BatchInput
+{
+	QByteArray formula;           //!< Chemical formula.
+	double     density;           //!< Compound density in g/cm^3.
+	double     xrayEnergy;        //!< X-Ray energy in eV.
+	double     neutronWavelength; //!< Neutron wavelength in nm.
+};
+
+/// The result of a single row of the BatchCalculator, the totals of 
+/// a CalcResult.
+struct BatchResult
+{
+	/// Creates an empty, successful result.
+	BatchResult();
+
+	/// Outcome of the calculation of a row.
+	typedef enum {
+		OK,              //!< All values are valid.
+		PARSE_ERROR,     //!< The formula is invalid.
+		UNKNOWN_ELEMENT, //!< The formula contains an unknown element.
+		INVALID_INPUT    //!< The row itself is malformed.
+	} Status;
+
+	Status      status;        //!< Outcome.
+	std::string error;         //!< Error message, if not OK.
+	double      electrons;     //!< Number of electrons.
+	double      mass;          //!< Molecular mass in g/mol.
+	double      volume;        //!< Molecular volume in nm^3.
+	complex     sldCoherent;   //!< Coherent neutron SLD in 1/cm^2.
+	complex     sldIncoherent; //!< Incoherent neutron SLD in 1/cm^2.
+	/// Outcome of the X-Ray calculation, see CalcResult::xrayStatus.
+	XraySpan::Status xrayStatus;
+	complex     sldXray;       //!< X-Ray SLD in 1/cm^2.
+};
+
+/**
+ * Calculates single rows, reusing its buffers. Each thread requires 
+ * its own RowCalculator, they may share the element database.
+ */
+class RowCalculator
+{
+public:
+	/// Creates a calculator which uses the specified database.
+	explicit RowCalculator(const ElementDatabase& db);
+
+	/// Calculates a single row. Errors are reported in the result.
+	void calculate(const BatchInput& in, BatchResult& out);
+
+	/// Calculates a single row and prepares the contrast variation of
+	/// the compound, see InputData::calcDeuteration(). A compound with
+	/// less hydrogen is reported as BatchResult::INVALID_INPUT.
+	/// \param[in] in The input row.
+	/// \param[in] exchangeable Number of exchangeable hydrogens.
+	/// \param[in] deuterable Number of deuterable hydrogens.
+	/// \param[out] series Receives the coefficients of the compound.
+	/// \param[out] out Receives the result of the compound as given.
+	void calculate(const BatchInput&  in, 
+	               double             exchangeable,
+	               double             deuterable,
+	               DeuterationSeries& series,
+	               BatchResult&       out);
+
+	/// Sets a cache of results, see InputData::setResultCache().
+	void setResultCache(ResultCache * cache);
+
+	/// Returns the complete result of the last row, including the 
+	/// neutron cross sections which BatchResult omits. It is valid 
+	/// until the next row is calculated.
+	const CalcResult& result() const { return mResult; }
+private:
+	/// Calculates a row, with the contrast variation if \e series is 
+	/// not NULL.
+	void process(const BatchInput&   in, 
+	             double              exchangeable,
+	             double              deuterable,
+	             DeuterationSeries * series,
+	             BatchResult&        out);
+
+	InputData  mInputData; //!< Own formula parser.
+	CalcResult mResult;    //!< Reused for all rows.
+};
+
+/**
+ * Calculates the characteristics of many compounds at once using all
+ * processor cores. 
+ *
+ * The rows are divided into chunks. Each worker thread takes the next 
+ * unprocessed chunk as soon as it is done with its recent one, so faster
+ * workers process more chunks. All workers share the element database
+ * which must not be modified meanwhile. A failing row is reported in 
+ * its result and does not affect the others.
+ */
+class BatchCalculator
+{
+public:
+	/// Creates a calculator which uses the specified database.
+	explicit BatchCalculator(const ElementDatabase& db);
+
+	/// Sets the number of rows processed by a worker at once.
+	void setChunkSize(int rows);
+
+	/// Sets the number of worker threads, defaults to the number of 
+	/// processor cores.
+	void setThreadCount(int threads);
+
+	/// Sets a cache of results shared by all workers, it is not used 
+	/// by default. Repeated rows are calculated once then.
+	void setResultCache(ResultCache * cache);
+
+	/// Calculates all rows. Blocks until all of them are done.
+	/// \param[in] input Rows to calculate.
+	/// \param[out] output Receives one result for each row, in the same
+	///             order.
+	void run(const std::vector<BatchInput>& input, 
+	         std::vector<BatchResult>&      output) const;
+private:
+	class Worker;
+
+	const ElementDatabase& mDB;    //!< Shared element database.
+	int              mChunkSize;   //!< See setChunkSize().
+	int              mThreadCount; //!< See setThreadCount().
+	ResultCache *    mCache;       //!< See setResultCache().
+};
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * src/binaryparser.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QFile>
+#include <QBuffer>
+#include <QResource>
+#include "binaryparser.h"
+#include "elementdatabase.h"
+
+const quint32 BinaryParser::MAGIC_NUMBER   = 0x51534c44; // "QSLD"
+const quint32 BinaryParser::FORMAT_VERSION = 1;
+
+/// Writes a single property value to a QDataStream, according to its type.
+class WritePropertyVariant: public boost::static_visitor<void>
+{
+	QDataStream& mOut;
+public:
+	WritePropertyVariant(QDataStream& out): mOut(out) {}
+	void operator()(const int& i) const         { mOut << qint32(i); }
+	void operator()(const std::string& s) const { mOut << QByteArray(s.c_str()); }
+	void operator()(const double& d) const      { mOut << d; }
+	void operator()(const complex& c) const     { mOut << c.real() << c.imag(); }
+};
+
+BinaryParser::BinaryParser()
+{
+}
+
+BinaryParser::~BinaryParser()
+{
+}
+
+const BinaryParser::ElementPtrList&
+BinaryParser::read(const QString& filename)
+{
+	mResultList.clear();
+	mImage.clear();
+
+	// deserialize uncompressed resources from their memory
+	QResource res(filename);
+	if (res.isValid() && !res.isCompressed()) {
+		mImage = QByteArray::fromRawData(
+			reinterpret_cast<const char *>(res.data()), res.size());
+	} else {
+		QFile file(filename);
+		if (!file.open(QIODevice::ReadOnly)) return mResultList;
+		mImage = file.readAll();
+	}
+
+	QBuffer buffer(&mImage);
+	buffer.open(QIODevice::ReadOnly);
+	QDataStream in(&buffer);
+	in.setVersion(QDataStream::Qt_4_5);
+	if (!readStream(in)) {
+#ifdef DEBUG
+		std::cerr << "BinaryParser::read, "
+			<< "invalid or outdated database image: '"
+			<< filename.toStdString() << "'" << std::endl;
+#endif
+		clear();
+	}
+	return mResultList;
+}
+
+bool
+BinaryParser::readStream(QDataStream& in)
+{
+	quint32 magic = 0, version = 0, propCount = 0, elemCount = 0;
+	in >> magic >> version >> propCount >> elemCount;
+	if (in.status() != QDataStream::Ok ||
+	    magic != MAGIC_NUMBER ||
+	    version != FORMAT_VERSION ||
+	    propCount != quint32(Element::propertyCount()))
+	{
+		return false;
+	}
+	for(quint32 i=0; i < elemCount; i++)
+	{
+		Element * e = readElement(in);
+		if (!e) return false;
+		mResultList.push_back(e);
+	}
+	return true;
+}
+
+Element *
+BinaryParser::readElement(QDataStream& in)
+{
+	Element * e = new Element();
+	for(int i=0; i < Element::propertyCount(); i++)
+	{
+		Element::Property p = Element::getProperty(i);
+		// the stored type may differ from the declared one for
+		// properties without data, setProperty() ignores those
+		quint8 type = Element::INVALID_TYPE;
+		in >> type;
+		switch(type) {
+			case Element::INT_TYPE: {
+				qint32 val = 0;
+				in >> val;
+				e->setProperty(p, int(val));
+				break; }
+			case Element::STRING_TYPE: {
+				QByteArray val;
+				in >> val;
+				e->setProperty(p, std::string(val.constData(), val.size()));
+				break; }
+			case Element::DOUBLE_TYPE: {
+				double val = 0.0;
+				in >> val;
+				e->setProperty(p, val);
+				break; }
+			case Element::COMPLEX_TYPE: {
+				double re = 0.0, im = 0.0;
+				in >> re >> im;
+				e->setProperty(p, complex(re, im));
+				break; }
+			default:
+				delete e;
+				return NULL;
+		}
+	}
+	quint32 count = 0;
+	in >> count;
+	for(quint32 i=0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		double energy = 0.0, fp = 0.0, fpp = 0.0;
+		in >> energy >> fp >> fpp;
+		e->addXrayCoefficient(energy, fp, fpp);
+	}
+	if (in.status() != QDataStream::Ok || !e->isValid()) {
+		delete e;
+		return NULL;
+	}
+	return e;
+}
+
+bool
+BinaryParser::write(const QString& filename, const ElementDatabase& db)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		return false;
+	}
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_4_5);
+	return write(out, db);
+}
+
+bool 
+BinaryParser::write(QDataStream& out, const ElementDatabase& db)
+{
+	QStringList keys(db.getSymbolList());
+	out << MAGIC_NUMBER << FORMAT_VERSION
+	    << quint32(Element::propertyCount()) << quint32(keys.size());
+	foreach(const QString& key, keys) {
+		ElementDatabase::Iterator it = db.find(key);
+		if (it == db.end() || !it.value()) return false;
+		writeElement(out, *it.value());
+	}
+	return out.status() == QDataStream::Ok;
+}
+
+void
+BinaryParser::writeElement(QDataStream& out, const Element& e)
+{
+	WritePropertyVariant writer(out);
+	for(int i=0; i < Element::propertyCount(); i++)
+	{
+		const Element::PropertyVariant& var =
+			e.propertyConst(Element::getProperty(i));
+		// same order as Element::PropertyType
+		out << quint8(var.which());
+		boost::apply_visitor(writer, var);
+	}
+	XraySpan xray = e.xrayCoefficients();
+	out << quint32(xray.size());
+	for(int i=0; i < xray.size(); i++) {
+		out << xray.energy(i) << xray.fp(i) << xray.fpp(i);
+	}
+}
+
+void
+BinaryParser::clear()
+{
+	foreach(Element::Ptr ep, mResultList) {
+		delete ep;
+	}
+	mResultList.clear();
+}
+
@@ -0,0 +1,122 @@
+/*
+ * src/binaryparser.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BINARY_PARSER
+#define BINARY_PARSER
+
+#include <QDataStream>
+#include "xmlparser.h"
+
+class ElementDatabase;
+
+/**
+ * Reads and writes the compiled binary image of the element database.
+ *
+ * The image is generated at build time from the XML element data files
+ * (see XmlParser and the \e qsldcalc-datacompiler target) and embedded
+ * in the resource file system. Loading it avoids parsing several
+ * megabytes of XML at every program start. The image is deserialized:
+ * new Elements are created and filled from it, like by XmlParser. It
+ * is not used in place as element store.
+ *
+ * Layout (QDataStream, big endian):
+ * \code
+ * quint32  magic number ("QSLD")
+ * quint32  format version, see FORMAT_VERSION
+ * quint32  number of properties per element, see Element::propertyCount()
+ * quint32  number of elements
+ * <per element>
+ *     <per property>  quint8 type of the stored value, see
+ *                     Element::PropertyType, followed by the value:
+ *                     qint32 | QByteArray (UTF-8) | double | double,double
+ *     quint32         number of X-ray scattering factor triples
+ *     <per triple>    double energy, double fp, double fpp
+ * \endcode
+ * An image with a different magic number, format version or property
+ * count is rejected as a whole.
+ */
+class BinaryParser
+{
+public:
+	/// List of plain pointers to new elements, owned by the caller.
+	typedef XmlParser::ElementPtrList ElementPtrList;
+
+	/// Identifies a binary element database image.
+	static const quint32 MAGIC_NUMBER;
+	/// Version of the binary layout. Has to be increased on every
+	/// change of the layout described above.
+	static const quint32 FORMAT_VERSION;
+public:
+	BinaryParser();  //!< Default constructor.
+	~BinaryParser(); //!< Destructor.
+
+	/// Reads all elements from a binary database image. Uncompressed
+	/// images in the resource file system are deserialized from the
+	/// resource memory, without copying the image first.
+	/// \param[in] filename Resource path or filename of the image.
+	/// \returns A list of all new elements extracted from the image. It
+	///          is empty if the image is missing, outdated or invalid.
+	const ElementPtrList& read(const QString& filename);
+
+	/// Writes all elements of a database to a binary image. The elements
+	/// are written in the order of their symbols to produce identical
+	/// images from identical data.
+	/// \param[in] filename Filename of the image to create.
+	/// \param[in] db Database to write.
+	/// \returns True on success, false otherwise.
+	static bool write(const QString& filename, const ElementDatabase& db);
+
+	/// Writes all elements of a database to an opened stream, as 
+	/// write() does.
+	/// \param[out] out Stream to write to.
+	/// \param[in] db Database to write.
+	/// \returns True on success, false otherwise.
+	static bool write(QDataStream& out, const ElementDatabase& db);
+
+	/// Returns the image of the last read() call, empty if it could not
+	/// be opened. It refers to the resource memory, if it was read from
+	/// there.
+	const QByteArray& image() const { return mImage; }
+private:
+	/// Reads all elements from an opened stream.
+	/// \returns False if the stream is not a valid image.
+	bool readStream(QDataStream& in);
+
+	/// Reads the next single element from the stream.
+	/// \returns A new element or NULL on failure.
+	static Element * readElement(QDataStream& in);
+
+	/// Writes a single element to the stream.
+	static void writeElement(QDataStream& out, const Element& e);
+
+	/// Frees all elements created by the last read() call.
+	void clear();
+private:
+	/// All Element Objects created by the current read() call.
+	ElementPtrList mResultList;
+	/// The image read by the current read() call, see image().
+	QByteArray     mImage;
+};
+
+#endif
+
@@ -0,0 +1,58 @@
+/*
+ * src/calcresult.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "calcresult.h"
+
+CalcResult::CalcResult()
+	: density(0.0), xrayEnergy(0.0), neutronWavelength(0.0)
+{
+	clear();
+}
+
+void 
+CalcResult::clear()
+{
+	partials.clear();
+	electrons = 0.0;
+	mass = 0.0;
+	volume = 0.0;
+	nslCoherent = nslIncoherent = complex(0.0, 0.0);
+	sldCoherent = sldIncoherent = complex(0.0, 0.0);
+	hasCrossSections = false;
+	absorption = incoherent = total = transmission = 0.0;
+	clearXray();
+}
+
+void 
+CalcResult::clearXray()
+{
+	for(size_t i = 0; i < partials.size(); i++) {
+		Partial& p = partials[i];
+		p.hasXray = false;
+		p.fp = p.fpp = 0.0;
+		p.sldXray = complex(0.0, 0.0);
+	}
+	xrayStatus = XraySpan::NO_DATA;
+	fp = fpp = 0.0;
+	sldXray = complex(0.0, 0.0);
+}
@@ -0,0 +1,114 @@
+/*
+ * src/calcresult.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CALC_RESULT_H
+#define CALC_RESULT_H
+
+#include <string>
+#include <vector>
+#include "element.h"
+#include "xraytable.h"
+
+/**
+ * Typed results of the compound calculation of InputData. It holds the
+ * total values of the compound and one Partial entry for each chemical
+ * element of the formula, in formula order. Its storage is reused by
+ * subsequent calculations.
+ *
+ * InputData converts it to the \e QVariantMap structure described there
+ * for display only.
+ */
+struct CalcResult
+{
+	/// Partial values of a single chemical element of the formula.
+	struct Partial
+	{
+		/// Nucleon number and symbol, 
+		/// see cfp::CompoundElement::uniqueName().
+		std::string name;
+		double      electrons;     //!< Number of electrons.
+		double      mass;          //!< Mass in g/mol.
+		double      massRatio;     //!< Mass ratio in %.
+		double      volume;        //!< Volume in nm^3.
+		complex     nslCoherent;   //!< Coherent scattering length in fm.
+		complex     nslIncoherent; //!< Incoherent scattering length in fm.
+		complex     sldCoherent;   //!< Coherent neutron SLD in 1/cm^2.
+		complex     sldIncoherent; //!< Incoherent neutron SLD in 1/cm^2.
+		/// There are X-Ray scattering factors for this element.
+		bool        hasXray;
+		double      fp;            //!< \f$ f'(E) \f$
+		double      fpp;           //!< \f$ f''(E) \f$
+		complex     sldXray;       //!< X-Ray SLD in 1/cm^2.
+	};
+
+	/// Creates an empty result.
+	CalcResult();
+
+	/// Resets all calculated values, keeps the input values and the
+	/// storage.
+	void clear();
+
+	/// Resets the X-Ray values of the totals and of all partials to
+	/// XraySpan::NO_DATA.
+	void clearXray();
+
+	// input values
+	double density;           //!< Compound density in g/cm^3.
+	double xrayEnergy;        //!< X-Ray energy in eV.
+	double neutronWavelength; //!< Neutron wavelength in nm.
+
+	/// Partial values of each chemical element.
+	std::vector<Partial> partials;
+
+	// totals
+	double  electrons;       //!< Number of electrons.
+	double  mass;            //!< Molecular mass in g/mol.
+	double  volume;          //!< Molecular volume in nm^3.
+	complex nslCoherent;     //!< Coherent scattering length in fm.
+	complex nslIncoherent;   //!< Incoherent scattering length in fm.
+	complex sldCoherent;     //!< Coherent neutron SLD in 1/cm^2.
+	complex sldIncoherent;   //!< Incoherent neutron SLD in 1/cm^2.
+
+	/// The neutron cross sections below are valid.
+	bool    hasCrossSections;
+	double  absorption;      //!< Macroscopic absorption cross section in 1/cm.
+	double  incoherent;      //!< Macroscopic incoherent cross section in 1/cm.
+	double  total;           //!< Macroscopic total cross section in 1/cm.
+	double  transmission;    //!< Transmission of 1 mm.
+
+	/// Outcome of the X-Ray calculation, the values below are valid
+	/// for XraySpan::EXACT or XraySpan::INTERPOLATED only. It is
+	/// XraySpan::NO_DATA if no element has scattering factors.
+	XraySpan::Status xrayStatus;
+	double  fp;              //!< \f$ f'(E) \f$
+	double  fpp;             //!< \f$ f''(E) \f$
+	complex sldXray;         //!< X-Ray SLD in 1/cm^2.
+
+	/// Tests if the X-Ray values are valid.
+	bool hasXray() const {
+		return xrayStatus == XraySpan::EXACT || 
+		       xrayStatus == XraySpan::INTERPOLATED;
+	}
+};
+
+#endif
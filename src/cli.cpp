@@ -0,0 +1,511 @@
+/*
+ * src/cli.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin, 
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Command line program: calculates compounds given as arguments or read
+// from files and writes the results as CSV or JSON to stdout. Uses the
+// backend only, there is no QApplication and no widget.
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <QDir>
+#include <QFile>
+#include "elementdatabase.h"
+#include "staticelementtable.h"
+#include "batchcalculator.h"
+#include "resultformat.h"
+#include "ndjsonserver.h"
+#include "resultcache.h"
+
+namespace {
+
+/// Default input values, the same as in the main window.
+const double DEFAULT_DENSITY = 1.1;       // g/cm^3
+const double DEFAULT_XRAY_ENERGY = 10.0;  // keV
+const double DEFAULT_WAVELENGTH = 0.6;    // nm
+const int DEFAULT_CACHE_SIZE = 64;        // MiB
+
+void 
+printUsage(const char * name)
+{
+	std::cerr << "USAGE: " << name << " [options] [formula ...]\n"
+		<< "Calculates the characteristics of each formula.\n\n"
+		<< "Options:\n"
+		<< "  -d, --density <g/cm^3>  compound density (default "
+		<< DEFAULT_DENSITY << ")\n"
+		<< "  -e, --energy <keV>      X-Ray energy (default "
+		<< DEFAULT_XRAY_ENERGY << ")\n"
+		<< "  -w, --wavelength <nm>   neutron wavelength (default "
+		<< DEFAULT_WAVELENGTH << ")\n"
+		<< "  -f, --file <file>       read rows from a file, '-' for stdin:\n"
+		<< "                          formula [density [energy [wavelength]]]\n"
+		<< "                          separated by blanks or commas,\n"
+		<< "                          '#' starts a comment\n"
+		<< "  -j, --threads <n>       number of threads (default: all cores)\n"
+		<< "      --data <dir>        read the element data from the XML\n"
+		<< "                          files in the directory instead of the\n"
+		<< "                          data compiled into the program\n"
+		<< "      --json              write one JSON object per line\n"
+		<< "                          instead of CSV\n"
+		<< "      --serve             serve requests, one JSON object per\n"
+		<< "                          line on stdin, until its end; keys:\n"
+		<< "                          formula, density, energy, wavelength\n"
+		<< "                          and id, the options above are defaults\n"
+		<< "      --queue <n>         maximum number of requests in progress\n"
+		<< "                          with --serve (default 1024)\n"
+		<< "      --cache <file>      reuse the results stored in the file\n"
+		<< "                          and store all results there at exit\n"
+		<< "      --cache-size <MiB>  reuse results of repeated formulas,\n"
+		<< "                          memory for them (default "
+		<< DEFAULT_CACHE_SIZE << " with --cache)\n"
+		<< "      --contrast <n>      contrast variation in H2O/D2O mixtures,\n"
+		<< "                          at n D2O fractions from 0 to 1\n"
+		<< "      --exchangeable <n>  hydrogens per formula exchanging with\n"
+		<< "                          the solvent (default 0)\n"
+		<< "      --deuterable <n>    hydrogens per formula which are\n"
+		<< "                          deuterated (default 0)\n"
+		<< "      --deuteration <l>   deuteration level of them, from 0 to 1\n"
+		<< "                          (default 1)\n"
+		<< "      --mixture <a,...>   mix the formulas, one amount per\n"
+		<< "                          formula, and calculate the mixture\n"
+		<< "      --mixture-unit <u>  unit of the amounts: g, cm3 or mol\n"
+		<< "                          (default g)\n"
+		<< "  -h, --help              show this help\n";
+}
+
+/// Parses a floating point number, the whole string has to match.
+bool 
+toDouble(const char * str, double& value)
+{
+	if (!str || !*str) return false;
+	char * end = 0;
+	value = strtod(str, &end);
+	return *end == '\0';
+}
+
+/// Parses a comma separated list of numbers which are not negative.
+bool 
+toAmounts(const char * str, std::vector<double>& amounts)
+{
+	if (!str) return false;
+	std::string list(str);
+	std::string::size_type pos = 0;
+	amounts.clear();
+	for (;;) {
+		std::string::size_type end = list.find(',', pos);
+		double value = 0.0;
+		if (!toDouble(list.substr(pos, end - pos).c_str(), value) || 
+		    !(value >= 0.0))
+		{
+			return false;
+		}
+		amounts.push_back(value);
+		if (end == std::string::npos) return true;
+		pos = end + 1;
+	}
+}
+
+/// Parses the unit of the amounts of a mixture.
+bool 
+toUnit(const char * str, Mixture::Unit& unit)
+{
+	if (!str) return false;
+	std::string name(str);
+	if (name == "g") unit = Mixture::MASS;
+	else if (name == "cm3") unit = Mixture::VOLUME;
+	else if (name == "mol") unit = Mixture::MOLES;
+	else return false;
+	return true;
+}
+
+/// Creates an input row with the default values of the command line.
+BatchInput 
+makeInput(const std::string& formula, const BatchInput& defaults)
+{
+	BatchInput in(defaults);
+	in.formula = QByteArray(formula.data(), int(formula.size()));
+	return in;
+}
+
+/// Reads input rows from a stream.
+/// \returns False on a malformed line.
+bool 
+readRows(std::istream& is, const char * name,
+         const BatchInput& defaults, std::vector<BatchInput>& rows)
+{
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(is, line)) 
+	{
+		lineNumber++;
+		std::string::size_type comment = line.find('#');
+		if (comment != std::string::npos) line.erase(comment);
+		for (size_t i = 0; i < line.size(); i++) {
+			if (line[i] == ',' || line[i] == ';' || line[i] == '\t' ||
+			    line[i] == '\r') 
+			{
+				line[i] = ' ';
+			}
+		}
+		std::vector<std::string> fields;
+		std::string::size_type pos = line.find_first_not_of(' ');
+		while (pos != std::string::npos) {
+			std::string::size_type end = line.find(' ', pos);
+			fields.push_back(line.substr(pos, end - pos));
+			pos = line.find_first_not_of(' ', end);
+		}
+		if (fields.empty()) continue;
+
+		BatchInput in = makeInput(fields[0], defaults);
+		double * values[] = { &in.density, &in.xrayEnergy, 
+		                      &in.neutronWavelength };
+		bool ok = (fields.size() <= 4);
+		for (size_t i = 1; ok && i < fields.size(); i++) {
+			ok = toDouble(fields[i].c_str(), *values[i-1]);
+		}
+		if (!ok) {
+			std::cerr << name << ":" << lineNumber 
+				<< ": invalid row '" << line << "' !" << std::endl;
+			return false;
+		}
+		in.xrayEnergy *= 1000.0; // keV -> eV
+		rows.push_back(in);
+	}
+	return true;
+}
+
+/// Loads the element data.
+/// \param[in] dataDir Directory of XML element data files to read
+///            instead of the compiled data, if not empty.
+/// \returns False if it could not be loaded.
+bool 
+loadDatabase(ElementDatabase& db, const std::string& dataDir)
+{
+	if (!dataDir.empty()) {
+		QString path(QString::fromLocal8Bit(dataDir.c_str()));
+		if (!QDir(path).exists()) return false;
+		db.addFromDirectory(path);
+		return db.begin() != db.end();
+	}
+#ifdef STATIC_ELEMENT_TABLE
+	db.addFromStaticTable(staticElementRecords, staticElementRecordCount);
+	return true;
+#else
+	// the program links the compiled image only, no XML files
+	return db.addFromBinary(":/elements.bin");
+#endif
+}
+
+/// Restores the results of previous runs, if there is a cache file.
+void 
+loadCache(ResultCache& cache, const std::string& fn, const ElementDatabase& db)
+{
+	if (fn.empty()) return;
+	QString name(QString::fromLocal8Bit(fn.c_str()));
+	if (QFile::exists(name) && !cache.load(name, db.fingerprint())) {
+		std::cerr << "ignoring outdated or invalid cache file '" 
+			<< fn << "'" << std::endl;
+	}
+}
+
+/// Stores all results for later runs, if there is a cache file.
+/// \returns False if it could not be written.
+bool 
+saveCache(const ResultCache& cache, const std::string& fn, 
+          const ElementDatabase& db)
+{
+	if (fn.empty()) return true;
+	QString name(QString::fromLocal8Bit(fn.c_str()));
+	if (!cache.save(name, db.fingerprint())) {
+		std::cerr << "could not write cache file '" << fn << "' !" 
+			<< std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Calculates and writes the contrast variation of all rows.
+/// \returns The number of rows which did not succeed.
+int 
+runContrast(const ElementDatabase& db, const std::vector<BatchInput>& rows,
+            int points, double exchangeable, double deuterable,
+            double deuteration, bool json)
+{
+	std::vector<double> d2o(points);
+	for (int i = 0; i < points; i++) {
+		d2o[i] = (points > 1 ? double(i) / (points-1) : 0.0);
+	}
+	RowCalculator calc(db);
+	DeuterationSeries series;
+	BatchResult result;
+	int failed = 0;
+	if (!json) printContrastHeader(stdout);
+	for (size_t i = 0; i < rows.size(); i++) {
+		series.setDeuteration(deuteration);
+		calc.calculate(rows[i], exchangeable, deuterable, series, result);
+		series.calculate(d2o.empty() ? 0 : &d2o[0], points);
+		printContrast(stdout, rows[i], result, d2o, series, json);
+		if (result.status != BatchResult::OK) failed++;
+	}
+	return failed;
+}
+
+/// Calculates and writes the mixture of all rows, each row is a 
+/// component. The transmission is given at the wavelength of the first.
+/// \returns False if a row did not succeed or the mixture is invalid.
+bool 
+runMixture(const ElementDatabase& db, const std::vector<BatchInput>& rows,
+           const std::vector<double>& amounts, Mixture::Unit unit, 
+           bool json)
+{
+	RowCalculator calc(db);
+	Mixture mixture;
+	std::vector<BatchResult> results(rows.size());
+	bool valid = true;
+	for (size_t i = 0; i < rows.size(); i++) {
+		calc.calculate(rows[i], results[i]);
+		if (results[i].status == BatchResult::OK) {
+			mixture.addComponent(calc.result());
+		} else {
+			mixture.addComponent(CalcResult());
+			valid = false;
+		}
+		if (!mixture.setAmount(int(i), amounts[i], unit)) valid = false;
+	}
+	valid = valid && mixture.calculate();
+	if (!json) printMixtureHeader(stdout);
+	printMixture(stdout, rows, results, amounts, mixture, valid, 
+	             rows[0].neutronWavelength, json);
+	return valid;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	BatchInput defaults;
+	defaults.density = DEFAULT_DENSITY;
+	defaults.xrayEnergy = DEFAULT_XRAY_ENERGY;
+	defaults.neutronWavelength = DEFAULT_WAVELENGTH;
+	std::vector<std::string> formulas, files;
+	bool json = false, serve = false;
+	int threads = 0, queue = 0, cacheSize = 0, contrast = 0;
+	double exchangeable = 0.0, deuterable = 0.0, deuteration = 1.0;
+	std::string cacheFile, dataDir;
+	std::vector<double> amounts;
+	Mixture::Unit unit = Mixture::MASS;
+
+	for (int i = 1; i < argc; i++) 
+	{
+		std::string arg(argv[i]);
+		const char * value = (i+1 < argc ? argv[i+1] : 0);
+		bool ok = true;
+		if (arg == "-h" || arg == "--help") {
+			printUsage(argv[0]);
+			return 0;
+		} else if (arg == "--json") {
+			json = true;
+		} else if (arg == "--serve") {
+			serve = true;
+		} else if (arg == "--queue") {
+			double n = 0.0;
+			ok = toDouble(value, n) && n >= 1.0;
+			queue = int(n);
+			i++;
+		} else if (arg == "--data") {
+			ok = (value != 0);
+			if (ok) dataDir = value;
+			i++;
+		} else if (arg == "--cache") {
+			ok = (value != 0);
+			if (ok) cacheFile = value;
+			i++;
+		} else if (arg == "--cache-size") {
+			double n = 0.0;
+			ok = toDouble(value, n) && n >= 1.0 && n < 2048.0;
+			cacheSize = int(n);
+			i++;
+		} else if (arg == "--contrast") {
+			double n = 0.0;
+			ok = toDouble(value, n) && n >= 1.0;
+			contrast = int(n);
+			i++;
+		} else if (arg == "--exchangeable") {
+			ok = toDouble(value, exchangeable) && exchangeable >= 0.0;
+			i++;
+		} else if (arg == "--deuterable") {
+			ok = toDouble(value, deuterable) && deuterable >= 0.0;
+			i++;
+		} else if (arg == "--deuteration") {
+			ok = toDouble(value, deuteration) && 
+			     deuteration >= 0.0 && deuteration <= 1.0;
+			i++;
+		} else if (arg == "--mixture") {
+			ok = toAmounts(value, amounts);
+			i++;
+		} else if (arg == "--mixture-unit") {
+			ok = toUnit(value, unit);
+			i++;
+		} else if (arg == "-d" || arg == "--density") {
+			ok = toDouble(value, defaults.density);
+			i++;
+		} else if (arg == "-e" || arg == "--energy") {
+			ok = toDouble(value, defaults.xrayEnergy);
+			i++;
+		} else if (arg == "-w" || arg == "--wavelength") {
+			ok = toDouble(value, defaults.neutronWavelength);
+			i++;
+		} else if (arg == "-j" || arg == "--threads") {
+			double n = 0.0;
+			ok = toDouble(value, n) && n >= 1.0;
+			threads = int(n);
+			i++;
+		} else if (arg == "-f" || arg == "--file") {
+			ok = (value != 0);
+			if (ok) files.push_back(value);
+			i++;
+		} else if (arg.size() > 1 && arg[0] == '-') {
+			ok = false;
+		} else {
+			formulas.push_back(arg);
+		}
+		if (!ok) {
+			std::cerr << argv[0] << ": invalid option '" << arg 
+				<< "' !" << std::endl;
+			printUsage(argv[0]);
+			return 2;
+		}
+	}
+
+	// caching is enabled by either option
+	if (!cacheFile.empty() && cacheSize == 0) {
+		cacheSize = DEFAULT_CACHE_SIZE;
+	}
+
+	if (serve) 
+	{
+		if (!formulas.empty() || !files.empty()) {
+			std::cerr << argv[0] << ": --serve reads stdin only !" 
+				<< std::endl;
+			return 2;
+		}
+		if (contrast > 0 || !amounts.empty()) {
+			std::cerr << argv[0] << ": --contrast and --mixture are not "
+				"available with --serve !" << std::endl;
+			return 2;
+		}
+		ElementDatabase db;
+		if (!loadDatabase(db, dataDir)) {
+			std::cerr << argv[0] << ": could not load the element data !"
+				<< std::endl;
+			return 1;
+		}
+		ResultCache cache(cacheSize*1024*1024);
+		loadCache(cache, cacheFile, db);
+		std::ios::sync_with_stdio(false);
+		NdjsonServer server(db, defaults);
+		if (threads > 0) server.setThreadCount(threads);
+		if (queue > 0) server.setQueueSize(queue);
+		if (cacheSize > 0) server.setResultCache(&cache);
+		int failed = server.run(std::cin, stdout);
+		if (!saveCache(cache, cacheFile, db)) return 1;
+		return failed > 0 ? 1 : 0;
+	}
+
+	// rows from the command line, then from files
+	std::vector<BatchInput> rows;
+	BatchInput eV(defaults);
+	eV.xrayEnergy *= 1000.0; // keV -> eV
+	for (size_t i = 0; i < formulas.size(); i++) {
+		rows.push_back(makeInput(formulas[i], eV));
+	}
+	for (size_t i = 0; i < files.size(); i++) 
+	{
+		bool ok;
+		if (files[i] == "-") {
+			ok = readRows(std::cin, "stdin", defaults, rows);
+		} else {
+			std::ifstream is(files[i].c_str());
+			if (!is) {
+				std::cerr << argv[0] << ": could not open '" 
+					<< files[i] << "' !" << std::endl;
+				return 1;
+			}
+			ok = readRows(is, files[i].c_str(), defaults, rows);
+		}
+		if (!ok) return 1;
+	}
+	if (rows.empty()) {
+		printUsage(argv[0]);
+		return 2;
+	}
+
+	if ((contrast > 0 || !amounts.empty()) && 
+	    (cacheSize > 0 || threads > 0)) 
+	{
+		std::cerr << argv[0] << ": --cache, --cache-size and --threads "
+			"are not available with --contrast and --mixture !" 
+			<< std::endl;
+		return 2;
+	}
+	if (!amounts.empty() && (contrast > 0 || amounts.size() != rows.size())) 
+	{
+		std::cerr << argv[0] << ": --mixture requires one amount per "
+			"formula and is not available with --contrast !" << std::endl;
+		return 2;
+	}
+
+	ElementDatabase db;
+	if (!loadDatabase(db, dataDir)) {
+		std::cerr << argv[0] << ": could not load the element data !"
+			<< std::endl;
+		return 1;
+	}
+	if (contrast > 0) {
+		int failed = runContrast(db, rows, contrast, exchangeable, 
+		                         deuterable, deuteration, json);
+		return failed > 0 ? 1 : 0;
+	}
+	if (!amounts.empty()) {
+		return runMixture(db, rows, amounts, unit, json) ? 0 : 1;
+	}
+	ResultCache cache(cacheSize*1024*1024);
+	loadCache(cache, cacheFile, db);
+	std::vector<BatchResult> results;
+	BatchCalculator calc(db);
+	if (threads > 0) calc.setThreadCount(threads);
+	if (cacheSize > 0) calc.setResultCache(&cache);
+	calc.run(rows, results);
+	if (!saveCache(cache, cacheFile, db)) return 1;
+
+	int failed = 0;
+	if (!json) printResultHeader(stdout);
+	for (size_t i = 0; i < rows.size(); i++) {
+		printResult(stdout, rows[i], results[i], json);
+		if (results[i].status != BatchResult::OK) failed++;
+	}
+	return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * src/compiledcompound.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPILED_COMPOUND_H
+#define COMPILED_COMPOUND_H
+
+#include <string>
+#include <vector>
+#include <cfp/cfp.h>
+#include "element.h"
+
+class InputData;
+
+/**
+ * A chemical formula compiled by InputData::compile(): parsed, with its
+ * aliases expanded and all of its elements looked up in the database.
+ * It can be evaluated by InputData::evaluate() any number of times for
+ * different input values without parsing or looking up anything again.
+ *
+ * It is immutable once compiled, thus it may be evaluated by several
+ * threads at once. It refers to the elements of the database and 
+ * becomes outdated when the database changes, see revision().
+ */
+class CompiledCompound
+{
+public:
+	/// A single chemical element of the compound.
+	struct Entry
+	{
+		/// The element in the database.
+		const Element * element;
+		/// The element which provides the X-Ray scattering factors, the
+		/// natural element for isotopes. NULL if it is missing in the
+		/// database.
+		const Element * xrayElement;
+		/// Row of \e element in the ElementTable of the database.
+		int             id;
+		/// Coefficient in the formula.
+		double          coefficient;
+		/// Nucleon number and symbol, 
+		/// see cfp::CompoundElement::uniqueName().
+		std::string     name;
+	};
+	/// All elements of a compound, in formula order.
+	typedef std::vector<Entry> EntryList;
+public:
+	/// Creates an empty compound.
+	CompiledCompound(): mRevision(-1) {}
+
+	/// Tests if there are no elements, i.e. nothing was compiled.
+	bool isEmpty() const { return mEntries.empty(); }
+
+	/// Returns the number of elements.
+	int size() const { return int(mEntries.size()); }
+
+	/// Returns the element with the specified index.
+	const Entry& at(int i) const { return mEntries[i]; }
+
+	/// Returns the empirical formula from parsing, aliases are not 
+	/// expanded.
+	const cfp::Compound& formula() const { return mFormula; }
+
+	/// Returns the canonical string representation of formula(), it
+	/// identifies the compound in the ResultCache.
+	const std::string& empirical() const { return mEmpirical; }
+
+	/// Returns the ElementDatabase::revision() the compound was compiled
+	/// with, it has to be compiled again if it changed.
+	int revision() const { return mRevision; }
+private:
+	friend class InputData;
+
+	EntryList     mEntries;   //!< See at().
+	cfp::Compound mFormula;   //!< See formula().
+	std::string   mEmpirical; //!< See empirical().
+	int           mRevision;  //!< See revision().
+};
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * src/datacompiler.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin, 
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Build time helper: compiles the XML element data files into the binary
+// database image which is embedded into the program (see BinaryParser) or
+// into a C++ source file defining static tables (see StaticElementTable).
+
+#include <iostream>
+#include "elementdatabase.h"
+#include "binaryparser.h"
+#include "staticelementtable.h"
+
+int main(int argc, char *argv[])
+{
+	const bool source = (argc == 4 && std::string(argv[1]) == "--source");
+	if (argc != 3 && !source) {
+		std::cerr << "USAGE: " << argv[0]
+			<< " [--source] <xml data directory> <output file>" << std::endl;
+		return 2;
+	}
+	const char * dataDir = argv[argc-2];
+	const char * outFile = argv[argc-1];
+
+	ElementDatabase db;
+	db.addFromDirectory(QString::fromLocal8Bit(dataDir));
+	if (db.begin() == db.end()) {
+		std::cerr << argv[0] << ": no element data found in '"
+			<< dataDir << "' !" << std::endl;
+		return 1;
+	}
+	const QString outName(QString::fromLocal8Bit(outFile));
+	bool ok = source ? StaticElementTable::write(outName, db)
+	                 : BinaryParser::write(outName, db);
+	if (!ok) {
+		std::cerr << argv[0] << ": could not write '"
+			<< outFile << "' !" << std::endl;
+		return 1;
+	}
+	return 0;
+}
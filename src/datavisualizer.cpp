@@ -97,7 +97,7 @@ DataVisualizer::display(int index)
 	for(; it != end; it++) 
 	{
 		Element::Ptr elem(it.value());
-		if (elem.isNull()) continue;
+		if (!elem) continue;
 		Element::PropertyVariant prop = elem->propertyConst(p);
 		boost::apply_visitor(PreparePropertyVariantForSorting(), prop);
 		elemMap.insert(prop, elem);
@@ -148,7 +148,7 @@ public:
 void 
 DataVisualizer::draw(SceneType scene, qreal& lastXPos, Element::Ptr e, int propertyIndex)
 {
-	if (e.isNull()) return;
+	if (!e) return;
 
 	// see if item should be drawn
 	Element::Property p(Element::getProperty(propertyIndex));
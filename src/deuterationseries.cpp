@@ -0,0 +1,115 @@
+/*
+ * src/deuterationseries.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "deuterationseries.h"
+
+DeuterationSeries::DeuterationSeries()
+	: mSld(0.0, 0.0), mExchange(0.0, 0.0), mDeuteration(0.0, 0.0),
+	  mSolventH2O(0.0, 0.0), mSolventD2O(0.0, 0.0),
+	  mEfficiency(1.0), mLevel(0.0)
+{
+}
+
+void 
+DeuterationSeries::setCompound(const complex& sld, 
+                               const complex& exchangeSlope,
+                               const complex& deuterationSlope)
+{
+	mSld = sld;
+	mExchange = exchangeSlope;
+	mDeuteration = deuterationSlope;
+}
+
+void 
+DeuterationSeries::setSolvent(const complex& sldH2O, const complex& sldD2O)
+{
+	mSolventH2O = sldH2O;
+	mSolventD2O = sldD2O;
+}
+
+complex 
+DeuterationSeries::baseSld() const
+{
+	return mSld + mLevel * mDeuteration;
+}
+
+complex 
+DeuterationSeries::sld(double d2o) const
+{
+	return baseSld() + (mEfficiency * d2o) * mExchange;
+}
+
+complex 
+DeuterationSeries::solventSld(double d2o) const
+{
+	return mSolventH2O + d2o * (mSolventD2O - mSolventH2O);
+}
+
+bool 
+DeuterationSeries::matchPoint(double& d2o) const
+{
+	// base + x*e*exchange = h2o + x*(d2o - h2o)
+	double slope = (mSolventD2O - mSolventH2O).real() - 
+	               mEfficiency * mExchange.real();
+	if (slope == 0.0) return false;
+	d2o = (baseSld() - mSolventH2O).real() / slope;
+	return true;
+}
+
+bool 
+DeuterationSeries::matchDeuteration(double d2o, double& level) const
+{
+	if (mDeuteration.real() == 0.0) return false;
+	complex offset = mSld + (mEfficiency * d2o) * mExchange;
+	level = (solventSld(d2o) - offset).real() / mDeuteration.real();
+	return true;
+}
+
+void 
+DeuterationSeries::calculate(const double * d2o, int count)
+{
+	if (count < 0) count = 0;
+	mSldReal.resize(count);
+	mSldImag.resize(count);
+	mSolvent.resize(count);
+	mContrast.resize(count);
+	if (count == 0) return;
+
+	// all values are linear in the fraction
+	const complex base(baseSld());
+	const complex exchange(mEfficiency * mExchange);
+	const double solventBase = mSolventH2O.real();
+	const double solventSlope = (mSolventD2O - mSolventH2O).real();
+	const double baseRe = base.real(), baseIm = base.imag();
+	const double exRe = exchange.real(), exIm = exchange.imag();
+	double * sldRe = &mSldReal[0];
+	double * sldIm = &mSldImag[0];
+	double * solvent = &mSolvent[0];
+	double * contrast = &mContrast[0];
+	for (int i = 0; i < count; i++) {
+		sldRe[i] = baseRe + d2o[i] * exRe;
+		sldIm[i] = baseIm + d2o[i] * exIm;
+		solvent[i] = solventBase + d2o[i] * solventSlope;
+		contrast[i] = sldRe[i] - solvent[i];
+	}
+}
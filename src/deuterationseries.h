@@ -0,0 +1,145 @@
+/*
+ * src/deuterationseries.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EDB_DEUTERATIONSERIES_H
+#define EDB_DEUTERATIONSERIES_H
+
+#include <vector>
+#include "element.h"
+
+/**
+ * Calculates the coherent neutron SLD of a compound in a mixture of
+ * \f$ H_2O \f$ and \f$ D_2O \f$ for contrast variation.
+ *
+ * Two kinds of hydrogen atoms of the compound may be replaced by 
+ * deuterium:
+ * - \e exchangeable (labile) ones exchange with the solvent, their 
+ *   deuterium fraction follows the \f$ D_2O \f$ fraction \f$ x \f$ of the
+ *   solvent, scaled by the exchange efficiency \f$ e \f$.
+ * - \e deuterable ones are deuterated synthetically to a fixed level 
+ *   \f$ y \f$, independent of the solvent.
+ *
+ * The volume of the compound does not change by deuteration, thus its
+ * SLD is linear in both fractions:
+ * \f[ \rho(x) = \rho_0 + e\,x\,\Delta\rho_{ex} + y\,\Delta\rho_{d} \f]
+ * where \f$ \Delta\rho_{ex} \f$ and \f$ \Delta\rho_{d} \f$ are the changes
+ * of the SLD if all hydrogens of the kind are replaced. The SLD of the
+ * solvent is linear in \f$ x \f$ as well. Therefore the curve over any 
+ * number of solvent fractions is a single multiply-add per point and the
+ * match point, where the contrast vanishes, is solved for directly.
+ * 
+ * InputData::calcDeuteration() sets up the coefficients of a compound.
+ */
+class DeuterationSeries
+{
+public:
+	/// Creates an empty compound in pure \f$ H_2O \f$.
+	DeuterationSeries();
+
+	/// Sets the SLD coefficients of the compound, in \f$ cm^{-2} \f$.
+	/// \param[in] sld Coherent SLD with all exchangeable and deuterable 
+	///            hydrogens protonated.
+	/// \param[in] exchangeSlope SLD change if all exchangeable hydrogens
+	///            are replaced by deuterium.
+	/// \param[in] deuterationSlope SLD change if all deuterable hydrogens
+	///            are replaced by deuterium.
+	void setCompound(const complex& sld, 
+	                 const complex& exchangeSlope,
+	                 const complex& deuterationSlope);
+
+	/// Sets the coherent SLD of pure \f$ H_2O \f$ and \f$ D_2O \f$ in 
+	/// \f$ cm^{-2} \f$.
+	void setSolvent(const complex& sldH2O, const complex& sldD2O);
+
+	/// Sets the fraction of exchangeable hydrogens which actually 
+	/// exchange with the solvent, defaults to 1.
+	void setExchangeEfficiency(double efficiency) { 
+		mEfficiency = efficiency; 
+	}
+
+	/// Sets the level of synthetic deuteration of the deuterable 
+	/// hydrogens, from 0 (protonated, default) to 1.
+	void setDeuteration(double level) { mLevel = level; }
+
+	/// Coherent SLD of the compound in \f$ cm^{-2} \f$.
+	/// \param[in] d2o Volume fraction of \f$ D_2O \f$ in the solvent.
+	complex sld(double d2o) const;
+
+	/// Coherent SLD of the solvent in \f$ cm^{-2} \f$.
+	/// \param[in] d2o Volume fraction of \f$ D_2O \f$ in the solvent.
+	complex solventSld(double d2o) const;
+
+	/// Solves for the solvent which matches the real part of the SLD of
+	/// the compound at the current deuteration level.
+	/// \param[out] d2o Receives the fraction of \f$ D_2O \f$, it may be 
+	///             outside of [0,1] if there is no such mixture.
+	/// \returns False, if the contrast does not depend on the solvent.
+	bool matchPoint(double& d2o) const;
+
+	/// Solves for the deuteration level which matches the compound to
+	/// the specified solvent.
+	/// \param[in] d2o Fraction of \f$ D_2O \f$ in the solvent.
+	/// \param[out] level Receives the deuteration level, it may be
+	///             outside of [0,1] if it is not achievable.
+	/// \returns False, if there are no deuterable hydrogens.
+	bool matchDeuteration(double d2o, double& level) const;
+
+	/// Calculates the contrast curve for many solvent mixtures.
+	/// \param[in] d2o Fractions of \f$ D_2O \f$ in the solvent.
+	/// \param[in] count Number of fractions.
+	void calculate(const double * d2o, int count);
+
+	int size() const { return int(mSldReal.size()); } //!< Number of fractions.
+
+	/// Real part of the compound SLD for each fraction.
+	const double * sldReal() const { return data(mSldReal); }
+	/// Imaginary part of the compound SLD for each fraction.
+	const double * sldImag() const { return data(mSldImag); }
+	/// Real part of the solvent SLD for each fraction.
+	const double * solventSld() const { return data(mSolvent); }
+	/// Real part of the SLD difference of compound and solvent for each
+	/// fraction.
+	const double * contrast() const { return data(mContrast); }
+private:
+	static const double * data(const std::vector<double>& v) {
+		return v.empty() ? 0 : &v[0];
+	}
+
+	/// SLD of the compound in \f$ H_2O \f$ at the current deuteration 
+	/// level.
+	complex baseSld() const;
+
+	complex             mSld;          //!< Protonated compound.
+	complex             mExchange;     //!< See setCompound().
+	complex             mDeuteration;  //!< See setCompound().
+	complex             mSolventH2O;   //!< SLD of \f$ H_2O \f$.
+	complex             mSolventD2O;   //!< SLD of \f$ D_2O \f$.
+	double              mEfficiency;   //!< See setExchangeEfficiency().
+	double              mLevel;        //!< See setDeuteration().
+	std::vector<double> mSldReal;      //!< See sldReal().
+	std::vector<double> mSldImag;      //!< See sldImag().
+	std::vector<double> mSolvent;      //!< See solventSld().
+	std::vector<double> mContrast;     //!< See contrast().
+};
+
+#endif
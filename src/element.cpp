@@ -22,6 +22,7 @@
  */
 
 #include "element.h"
+#include "elementtable.h"
 
 const int    Element::INVALID_PROPERTY_VALUE = -2;
 
@@ -43,28 +44,46 @@ const char * Element::mPropertyNames[] = {
 
 Element::Element()
 	: cfp::ChemicalElementInterface(),
-	  // init properties (max+1 to avoid out-of-range, see propertyConst())
-	  mProperties(INVALID_PROPERTY+1)
-{
-	for(int i=0; i < propertyCount(); i++) {
-		Property p = getProperty(i);
-		switch(p) {
-			case STRING_TYPE:
-				mProperties.at(p) = defaultValue(std::string(), p); break;
-			case INT_TYPE:
-				mProperties.at(p) = defaultValue(int(), p); break;
-			case DOUBLE_TYPE:
-				mProperties.at(p) = defaultValue(double(), p); break;
-			case COMPLEX_TYPE:
-				mProperties.at(p) = defaultValue(complex(), p); break;
-			default:
-				mProperties.at(p) = INVALID_PROPERTY_VALUE; break;
-		}
-	}
+	  mTable(new ElementTable()),
+	  mId(0),
+	  mOwnsTable(true),
+	  mXrayGrids(NULL),
+	  mXrayElement(this),
+	  mXraySource(NULL),
+	  mXrayPending(0)
+{
+	mId = mTable->addRow();
 }
 
 Element::~Element()
 {
+	if (mOwnsTable) delete mTable;
+	delete mXraySource;
+}
+
+const ElementTable& 
+Element::table() const
+{
+	return *mTable;
+}
+
+int 
+Element::id() const
+{
+	return mId;
+}
+
+void 
+Element::moveTo(ElementTable& table, int id)
+{
+	if (&table == mTable) return;
+	int newId = id;
+	if (newId < 0) newId = table.addRow(*mTable, mId);
+	else           table.copyRow(newId, *mTable, mId);
+	if (mOwnsTable) delete mTable;
+	mTable = &table;
+	mId = newId;
+	mOwnsTable = false;
 }
 
 const char * 
@@ -129,33 +148,150 @@ Element::isValidType(Property p, const PropertyVariant& var)
 bool 
 Element::isValid() const 
 {
-	try {
-		const std::string& sym  = boost::get<std::string>(propertyConst(SYMBOL_PROPERTY));
-		const std::string& name = boost::get<std::string>(propertyConst(NAME_PROPERTY));
-		const int& nuc   = boost::get<int>(propertyConst(NUCLEONS_PROPERTY));
-		const int& elec  = boost::get<int>(propertyConst(ELECTRONS_PROPERTY));
-		const double& ab = boost::get<double>(propertyConst(ABUNDANCE_PROPERTY));
-		const double& am = boost::get<double>(propertyConst(ATOMIC_MASS_PROPERTY));
-		return !sym.empty() &&
-		       !name.empty() &&
-		       elec > 0 &&
-		       nuc != 0 &&
-		       ab >= 0.0 &&
-		       am > 0.0;
-	} catch(boost::bad_get e) { return false; }
-}
-
-const MapTriple& 
+	std::string sym, name;
+	int nuc = 0, elec = 0;
+	double ab = 0.0, am = 0.0;
+	return mTable->get<SYMBOL_PROPERTY>(mId, sym) &&
+	       mTable->get<NAME_PROPERTY>(mId, name) &&
+	       mTable->get<NUCLEONS_PROPERTY>(mId, nuc) &&
+	       mTable->get<ELECTRONS_PROPERTY>(mId, elec) &&
+	       mTable->get<ABUNDANCE_PROPERTY>(mId, ab) &&
+	       mTable->get<ATOMIC_MASS_PROPERTY>(mId, am) &&
+	       !sym.empty() &&
+	       !name.empty() &&
+	       elec > 0 &&
+	       nuc != 0 &&
+	       ab >= 0.0 &&
+	       am > 0.0;
+}
+
+XraySpan 
 Element::xrayCoefficients() const 
 {
-	return mXrayCoefficients;
+	loadXrayCoefficients();
+	return mXraySpan;
+}
+
+XraySpan::Status 
+Element::xrayCoefficientsAt(double energy, double& fp, double& fpp) const
+{
+	return xrayCoefficients().interpolate(energy, fp, fpp);
+}
+
+void 
+Element::setXrayCoefficients(const XraySpan& coefficients)
+{
+	setXrayCoefficientsSource(NULL);
+	mXrayTable.clear();
+	mXrayCubic.clear();
+	mXraySpan = coefficients;
+	mXraySpan.setCubic(NULL);
+	// the interpolation is prepared on first access
+	mXrayPending.fetchAndStoreOrdered(mXraySpan.empty() ? 0 : 1);
+}
+
+void 
+Element::setXrayGridPool(XrayGridPool * pool)
+{
+	QMutexLocker lock(&mXrayMutex);
+	mXrayGrids = pool;
+	// otherwise, shared after reading from the source
+	if (!mXraySource) shareXrayGrid();
+	// the factors are complete, interpolated cubically from first access
+	if (!mXraySpan.empty() || mXraySource) {
+		mXrayPending.fetchAndStoreOrdered(1);
+	}
+}
+
+const Element * 
+Element::xrayElement() const
+{
+	return mXrayElement;
+}
+
+void 
+Element::setXrayElement(const Element * e)
+{
+	mXrayElement = e;
+}
+
+void 
+Element::shareXrayGrid()
+{
+	if (!mXrayGrids || mXraySpan.empty() || mXraySpan.grid()) return;
+	// external data is static, only own energies have to be copied
+	const bool owned = (mXraySpan.energies() == mXrayTable.span().energies());
+	const XrayGrid * grid = mXrayGrids->intern(
+		mXraySpan.energies(), mXraySpan.size(), owned);
+	mXraySpan = XraySpan(grid, mXraySpan.fps(), mXraySpan.fpps());
+	if (owned) mXrayTable.releaseEnergies();
+}
+
+void 
+Element::prepareXrayInterpolation()
+{
+	shareXrayGrid();
+	if (mXrayCubic.empty()) mXrayCubic.build(mXraySpan);
+	mXraySpan.setCubic(mXrayCubic.empty() ? NULL : &mXrayCubic);
+}
+
+void 
+Element::setXrayCoefficientsSource(XrayCoefficientsSource * src)
+{
+	QMutexLocker lock(&mXrayMutex);
+	delete mXraySource;
+	mXraySource = src;
+	mXrayCubic.clear();
+	mXrayPending.fetchAndStoreOrdered(src ? 1 : 0);
+}
+
+void 
+Element::loadXrayCoefficients() const
+{
+	// double-checked, the mutex is locked only while loading
+	if (!mXrayPending.testAndSetAcquire(1, 1)) return;
+	QMutexLocker lock(&mXrayMutex);
+	if (!mXrayPending.testAndSetAcquire(1, 1)) return;
+
+	// reading the data is not a visible modification
+	Element * self = const_cast<Element *>(this);
+	XrayCoefficientsSource * src = self->mXraySource;
+	if (src) {
+		self->mXraySource = NULL;
+		bool ok = src->load(self->mXrayTable);
+		self->mXraySpan = mXrayTable.span();
+		if (!ok) {
+#ifdef DEBUG
+			std::cerr << "Element::loadXrayCoefficients: "
+				<< "Could not read X-ray data of " << uniqueName()
+				<< std::endl;
+#endif
+		}
+		delete src;
+	}
+	self->prepareXrayInterpolation();
+	mXrayPending.fetchAndStoreRelease(0);
 }
 
 void 
 Element::addXrayCoefficient(double energy, double fp, double fpp)
 {
-	size_t num = mXrayCoefficients.erase(energy);
-	if (num > 0) {
+	loadXrayCoefficients();
+	if (mXraySpan.energies() != mXrayTable.span().energies()) {
+		// copy external or shared data first
+		XrayTable copy;
+		copy.reserve(mXraySpan.size() + 1);
+		for(int i=0; i < mXraySpan.size(); i++) {
+			copy.add(mXraySpan.energy(i),
+				mXraySpan.fp(i), mXraySpan.fpp(i));
+		}
+		mXrayTable.swap(copy);
+	}
+	bool overwritten = mXrayTable.add(energy, fp, fpp);
+	// interpolated linearly until the element is complete
+	mXrayCubic.clear();
+	mXraySpan = mXrayTable.span();
+	if (overwritten) {
 #ifdef DEBUG
 		std::cerr << "Element::addXrayCoefficient: "
 			<< "Found duplicate: " << symbol() 
@@ -164,62 +300,63 @@ Element::addXrayCoefficient(double energy, double fp, double fpp)
 			<< std::endl;
 #endif
 	}
-	mXrayCoefficients.insert(std::make_pair(energy,
-	                         std::make_pair(fp, fpp)));
-}
-
-Element::PropertyValueIteratorConst 
-Element::beginConst() const { return mProperties.begin(); }
-
-Element::PropertyValueIteratorConst 
-Element::endConst() const { return mProperties.end(); }
-
-Element::Property 
-Element::getProperty(const PropertyValueIteratorConst& iter) const 
-{
-	return getProperty(iter - beginConst());
 }
 
 double 
 Element::electrons() const 
 { 
-	return getValue<int>(ELECTRONS_PROPERTY);
+	return get<ELECTRONS_PROPERTY>();
 }
 
 double 
 Element::atomicMass() const
 {
-	return getValue<double>(ATOMIC_MASS_PROPERTY);
+	return get<ATOMIC_MASS_PROPERTY>();
 }
 
 complex 
 Element::nslCoherent() const
 {
-	return getValue<complex>(NS_L_COHERENT_PROPERTY);
+	return get<NS_L_COHERENT_PROPERTY>();
 }
 
 complex 
 Element::nslIncoherent() const
 {
-	return getValue<complex>(NS_L_INCOHERENT_PROPERTY);
+	return get<NS_L_INCOHERENT_PROPERTY>();
+}
+
+double 
+Element::nsCsIncoherent() const
+{
+	return get<NS_CS_INCOHERENT_PROPERTY>();
+}
+
+double 
+Element::nsCsTotal() const
+{
+	return get<NS_CS_TOTAL_PROPERTY>();
+}
+
+double 
+Element::nsCsAbsorption() const
+{
+	return get<NS_CS_ABSORPTION_PROPERTY>();
 }
 
 std::ostream& 
 operator<<(std::ostream& o, const Element& e)
 {
-	Element::PropertyValueIteratorConst pit = e.beginConst();
-	for(; pit != e.endConst(); pit++)
+	for(int i=0; i < Element::propertyCount(); i++)
 	{
-		o << *pit << " ";
+		o << e.propertyConst(Element::getProperty(i)) << " ";
 	}
 	o << std::endl;
-	const MapTriple& map = e.xrayCoefficients();
-	MapTriple::const_iterator it = map.begin();
-	while (it != map.end() )
+	XraySpan xray = e.xrayCoefficients();
+	for(int i=0; i < xray.size(); i++)
 	{
-		o << it->first << "\t" << it->second.first << "\t" << it->second.second
+		o << xray.energy(i) << "\t" << xray.fp(i) << "\t" << xray.fpp(i)
 			<< std::endl;
-		it++;
 	}
 	return o;
 }
@@ -234,28 +371,16 @@ std::operator<(const ::complex& a, const ::complex& b)
 
 // private //
 
-Element::PropertyValueIterator 
-Element::begin()
-{
-	return mProperties.begin();
-}
-
-Element::PropertyValueIterator
-Element::end()
-{
-	return mProperties.end();
-}
-
-Element::Property 
-Element::getProperty(const PropertyValueIterator& iter) const 
+bool 
+Element::setVariant(Property p, const PropertyVariant& var)
 {
-	return getProperty(iter - beginConst());
+	return mTable->setValue(p, mId, var);
 }
 
 std::string 
 Element::doSymbol() const 
 {
-	return getValue<std::string>(SYMBOL_PROPERTY);
+	return get<SYMBOL_PROPERTY>();
 }
 
 void 
@@ -267,7 +392,7 @@ Element::doSetSymbol(const std::string& s)
 int 
 Element::doNucleons() const
 {
-	return getValue<int>(NUCLEONS_PROPERTY);
+	return get<NUCLEONS_PROPERTY>();
 }
 
 void 
@@ -295,5 +420,5 @@ Element::defaultValue(complex a, Element::Property p)
 std::string 
 Element::defaultValue(std::string a, Element::Property p) { return ""; }
 
-const Element::PropertyVariant& 
-Element::propertyConst(Element::Property p) const { return mProperties.at(p); }
+Element::PropertyVariant 
+Element::propertyConst(Element::Property p) const { return mTable->value(p, mId); }
@@ -26,30 +26,47 @@
 
 #include <complex>
 #include <vector>
-#include <map>
 #include <iostream> // remove me
-#include <QPointer>
+#include <QMutex>
+#include <QAtomicInt>
 #include <cfp/cfp.h>
 #include <boost/variant.hpp>
+#include "xraytable.h"
 
 /// Complex numbers in floating point representation.
 typedef std::complex<double> complex;
 
-/// A tuple of floating point numbers
-typedef std::pair<double, double> DoublePair;
+class ElementTable;
 
-/// A Map of floating point numbers used to store the Xray
-/// scattering factors indexed by their energy.
-/// \sa Element::xrayCoefficients()
-typedef std::map<double, DoublePair> MapTriple;
+/**
+ * Deferred source of the X-Ray scattering factors of an Element. Most of
+ * the element data volume consists of these factors while they are
+ * rarely used. They are read on first access instead.
+ * \sa Element::setXrayCoefficientsSource()
+ */
+class XrayCoefficientsSource
+{
+public:
+	virtual ~XrayCoefficientsSource() {}
+
+	/// Reads the X-Ray scattering factors. Triples with the same
+	/// energy value overwrite previous ones.
+	/// \param[out] coefficients Container to add the factors to.
+	/// \returns False, if the factors could not be read.
+	virtual bool load(XrayTable& coefficients) const = 0;
+};
 
 /**
  * A real-world chemical element. It is used to store all relevant
  * characteristics and provide dynamic, i.e. automated, access to 
  * them. It is compatible to cfp::ChemicalElement but stores its data
- * in a different manner: a container of variants (PropertyVariant).
+ * in a different manner: in a row of a column-oriented ElementTable.
+ * Property values are exchanged as variants (PropertyVariant),
  * boost::variant is used to accomplish this.
  *
+ * A new Element owns a table of its own. It is moved to the shared
+ * table of a database by moveTo().
+ *
  * <b>Data sources</b>:
  * - For neutron scattering length and cross sections, the data is
  *   taken from http://www.ncnr.nist.gov/resources/n-lengths/list.html
@@ -79,15 +96,18 @@ typedef std::map<double, DoublePair> MapTriple;
  * boost::variant was to maintain independence from Qt to allow for
  * outsourcing the database code into a separate library (may be
  * useful for other programs too).
- * \todo Wrap the internal data representation (Element::PropertyVariant) into
- * a separate class. Eventually, the type identification code too
- * (Element::Property and Element::PropertyType).
  */
 class Element: public cfp::ChemicalElementInterface, public QObject
 {
 public:
-	/// A guarded Pointer to such an Element.
-	typedef QPointer<Element> Ptr;
+	/// A plain pointer to such an Element. It is trivially copyable, 
+	/// unlike QPointer which registers each copy in a global guard 
+	/// table protected by a mutex. Elements are owned by the 
+	/// ElementDatabase they were added to and live as long as it does.
+	typedef Element * Ptr;
+	/// Read-only pointer to an Element of the ElementDatabase, which 
+	/// is not modified after it was added. Safe to share between threads.
+	typedef const Element * ConstPtr;
 
 	/// All properties of an Element in the database.
 	typedef enum {
@@ -133,18 +153,18 @@ public:
 	typedef boost::variant<int, std::string, double, complex> PropertyVariant;
 	/// Container for all defined properties.
 	typedef std::vector<Property> PropertyVector;
-	/// Container for all defined property values, the data.
-	typedef std::vector<PropertyVariant> PropertyVariantVector;
-	typedef PropertyVariantVector::const_iterator PropertyValueIteratorConst;
-	typedef PropertyVariantVector::iterator PropertyValueIterator;
 	/// Default value for properties with invalid type.
 	/// \sa PropertyType
 	static const int INVALID_PROPERTY_VALUE;
+	/// Compile-time description of a property, specialized for each
+	/// Property with a valid type below this class. Its member 
+	/// \e ValueType is the C++ type of the values, which matches 
+	/// propertyType().
+	template<Property P> struct PropertyTraits;
 public:
-	/// Initializes all properties of this Element.
-	/// Sets all properties to valid types and values accordingly.
-	/// The values are valid regarding their Element::PropertyType but may
-	/// not be valid from a physical point of view.
+	/// Creates an Element without any property data in a table of
+	/// its own. Properties without data have the value
+	/// INVALID_PROPERTY_VALUE.
 	/// \sa isValid()
 	Element();
 
@@ -170,57 +190,116 @@ public:
 	/// Tests if the given property value matches the given property.
 	static bool isValidType(Property p, const PropertyVariant& var);
 
-	/// Returns a read-only iterator to the first of all property values.
-	PropertyValueIteratorConst beginConst() const;
-
-	/// Returns a read-only iterator which points behind the last
-	/// property value.
-	PropertyValueIteratorConst endConst() const;
-
-	/// Returns the Property of the specified property value
-	/// iterator created with beginConst() or endConst();
-	Property getProperty(const PropertyValueIteratorConst& iter) const;
-
 	/// Returns the property value associated with the specified property.
-	const PropertyVariant& propertyConst(Property p) const;
+	PropertyVariant propertyConst(Property p) const;
 
 	/// Sets the specified property to the provided value.
 	template<typename T>
 	bool setProperty(Property p, const T& value);
 
+	/// Returns the value of a property, its type is determined at 
+	/// compile time by PropertyTraits, e.g. get<ATOMIC_MASS_PROPERTY>().
+	/// Without data, the default value of the property is returned.
+	/// Defined in elementtable.h, which is included below.
+	template<Property P>
+	typename PropertyTraits<P>::ValueType get() const;
+
 	double electrons() const;     //!< \conv \see ELECTRONS_PROPERTY
 	double atomicMass() const;    //!< \conv \see ATOMIC_MASS_PROPERTY
 	complex nslCoherent() const;  //!< \conv \see NS_L_COHERENT_PROPERTY
 	complex nslIncoherent() const;//!< \conv \see NS_L_INCOHERENT_PROPERTY
+	double nsCsIncoherent() const;//!< \conv \see NS_CS_INCOHERENT_PROPERTY
+	double nsCsTotal() const;     //!< \conv \see NS_CS_TOTAL_PROPERTY
+	double nsCsAbsorption() const;//!< \conv \see NS_CS_ABSORPTION_PROPERTY
 	
 	/// Tests this element for (physical) valid property values.
 	bool isValid() const;
 
 	/// Provides read-only access to the X-Ray scattering factors.
 	/// See the \ref xrayFactors "description above".
-	const MapTriple& xrayCoefficients() const;
+	/// Reads them from a deferred source on first access, which is
+	/// safe to happen from several threads at once. The view stays
+	/// valid until the factors are modified. Once the factors are
+	/// complete, i.e. read, set by setXrayCoefficients() or added to a
+	/// database, cubic interpolation coefficients are computed on the
+	/// next access and attached, see XrayCubic.
+	XraySpan xrayCoefficients() const;
+
+	/// Determines the X-Ray scattering factors at the specified energy,
+	/// see XraySpan::interpolate(). It is a read-only operation, safe
+	/// to be called from several threads at once, as long as the
+	/// factors are not modified by addXrayCoefficient() at the same time.
+	XraySpan::Status xrayCoefficientsAt(double energy,
+	                                    double& fp, double& fpp) const;
 
 	/// Adds a new triple \f$ [ E, f'(E), f''(E) ] \f$ to the X-Ray
 	/// scattering factors. Overwrites existing triples with the
 	/// same energy value.
 	void addXrayCoefficient(double energy, double fp, double fpp);
 
+	/// Uses existing X-Ray scattering factors without copying them,
+	/// e.g. those of a StaticElementTable. They are copied on the
+	/// first modification by addXrayCoefficient().
+	/// \param[in] coefficients View of the factors, the data has to
+	///            outlive this Element.
+	void setXrayCoefficients(const XraySpan& coefficients);
+
+	/// Defers reading the X-Ray scattering factors until they are
+	/// accessed by xrayCoefficients(). Takes ownership of the source.
+	void setXrayCoefficientsSource(XrayCoefficientsSource * src);
+
+	/// Shares the energies of the X-Ray scattering factors with all
+	/// other elements with the same energy grid. Happens when the
+	/// factors are available, immediately or after they were read from
+	/// a deferred source. Only f' and f'' are stored per Element then.
+	/// \param[in] pool Pool of energy grids, which has to outlive this
+	///            Element.
+	void setXrayGridPool(XrayGridPool * pool);
+
+	/// Returns the Element which provides the X-Ray scattering factors
+	/// of this one. That is the Element itself, isotopes have no X-Ray
+	/// data of their own and refer to the natural element of the
+	/// database instead. NULL if the database lacks it.
+	const Element * xrayElement() const;
+
+	/// Links this Element to the one providing its X-Ray scattering 
+	/// factors, see xrayElement(). Set by the database for all of its
+	/// elements when they are loaded.
+	void setXrayElement(const Element * e);
+
+	/// Returns the table which stores the properties of this Element.
+	const ElementTable& table() const;
+
+	/// Returns the row of this Element in table().
+	int id() const;
+
+	/// Moves the properties of this Element to a new row of the
+	/// specified table, which has to outlive this Element. Used by
+	/// the database to store all its elements in a single table.
+	/// \param[in] table Table to move to.
+	/// \param[in] id Existing row to overwrite, the row of an Element
+	///            which is replaced by this one. A new row is appended
+	///            if it is negative.
+	void moveTo(ElementTable& table, int id = -1);
+
 private:
-	/// Returns a read/write iterator to the first of all property values.
-	PropertyValueIterator begin();
+	/// Stores a property value which was checked by setProperty().
+	bool setVariant(Property p, const PropertyVariant& var);
 
-	/// Returns a read/write iterator which points behind the last
-	/// property value.
-	PropertyValueIterator end();
+	/// Reads the X-Ray scattering factors from a deferred source, if
+	/// there is one, and prepares their interpolation. Only the first
+	/// call after the factors were completed does something.
+	void loadXrayCoefficients() const;
 
-	/// Returns the Property of the specified property value
-	/// iterator created with begin() or end();
-	Property getProperty(const PropertyValueIterator& iter) const;
+	/// Replaces the energies of the X-Ray scattering factors by a grid
+	/// of the pool, if there is one. Expects exclusive access.
+	void shareXrayGrid();
 
-	/// Returns the value of given property p. The chosen type
-	/// must match that of the given property.
-	template<typename T>
-	T getValue(Property p) const;
+	/// Shares the energy grid and attaches the coefficients of the 
+	/// cubic interpolation to the X-Ray scattering factors. Computes 
+	/// them if they were cleared by a modification. Expects exclusive
+	/// access.
+	void prepareXrayInterpolation();
 
 	/// Implementation of data access for cfp::ChemicalElementInterface.
 	virtual std::string doSymbol() const;
@@ -240,26 +319,36 @@ private:
 	/// Explicitly typified default value for property \e p.
 	static std::string defaultValue(std::string a, Element::Property p);
 private:
-	/// Container for all property values.
-	PropertyVariantVector mProperties;
+	/// Table which stores all property values.
+	ElementTable * mTable;
+	/// Row of this Element in mTable.
+	int mId;
+	/// True, if mTable was created by and for this Element.
+	bool mOwnsTable;
 	/// Points to the names of all properties.
 	static const char * mPropertyNames[INVALID_PROPERTY];
-	/// Container for \ref xrayFactors "X-Ray scattering factors".
-	MapTriple mXrayCoefficients;
+	/// Container for \ref xrayFactors "X-Ray scattering factors",
+	/// unused while mXraySpan refers to external data.
+	XrayTable mXrayTable;
+	/// View of the current X-Ray scattering factors.
+	XraySpan mXraySpan;
+	/// Cubic interpolation coefficients of mXraySpan, empty while it
+	/// is interpolated linearly.
+	XrayCubic mXrayCubic;
+	/// Pool of shared energy grids, may be NULL.
+	XrayGridPool * mXrayGrids;
+	/// See xrayElement().
+	const Element * mXrayElement;
+	/// Deferred source of the X-Ray scattering factors, NULL if they
+	/// are available already.
+	XrayCoefficientsSource * mXraySource;
+	/// Non-zero while the factors have to be read from the deferred
+	/// source or their interpolation has to be prepared.
+	mutable QAtomicInt mXrayPending;
+	/// Serializes the first access to the X-Ray scattering factors.
+	mutable QMutex mXrayMutex;
 };
 
-template<typename T>
-T Element::getValue(Property p) const 
-{
-	try {	return boost::get<T>(propertyConst(p));
-	} catch(boost::bad_get e) {
-#ifdef DEBUG
-		std::cerr << "exec " << propertyName(p) << std::endl;
-#endif
-		return defaultValue(T(), p);
-	}
-}
-
 template<typename T>
 bool Element::setProperty(Property p, const T& value)
 {
@@ -275,10 +364,28 @@ bool Element::setProperty(Property p, const T& value)
 		if (value < T(0)) var = T(0);
 	}
 
-	mProperties.at(p) = var;
-	return true;
+	return setVariant(p, var);
 }
 
+/// Declares the value type of a property, see Element::PropertyTraits.
+#define EDB_PROPERTY_TRAITS(PROPERTY, TYPE) \
+	template<> struct Element::PropertyTraits<Element::PROPERTY> { \
+		typedef TYPE ValueType; \
+	};
+EDB_PROPERTY_TRAITS(SYMBOL_PROPERTY,           std::string)
+EDB_PROPERTY_TRAITS(NAME_PROPERTY,             std::string)
+EDB_PROPERTY_TRAITS(NUCLEONS_PROPERTY,         int)
+EDB_PROPERTY_TRAITS(ELECTRONS_PROPERTY,        int)
+EDB_PROPERTY_TRAITS(ATOMIC_MASS_PROPERTY,      double)
+EDB_PROPERTY_TRAITS(ABUNDANCE_PROPERTY,        double)
+EDB_PROPERTY_TRAITS(NS_L_COHERENT_PROPERTY,    complex)
+EDB_PROPERTY_TRAITS(NS_L_INCOHERENT_PROPERTY,  complex)
+EDB_PROPERTY_TRAITS(NS_CS_COHERENT_PROPERTY,   double)
+EDB_PROPERTY_TRAITS(NS_CS_INCOHERENT_PROPERTY, double)
+EDB_PROPERTY_TRAITS(NS_CS_TOTAL_PROPERTY,      double)
+EDB_PROPERTY_TRAITS(NS_CS_ABSORPTION_PROPERTY, double)
+#undef EDB_PROPERTY_TRAITS
+
 /// Feed the string representation of a database element to a std::stream.
 std::ostream& operator<<(std::ostream& o, const Element& e);
 namespace std {
@@ -286,5 +393,8 @@ namespace std {
 bool operator<(const ::complex& a, const ::complex& b);
 }
 
+// definition of Element::get(), requires the complete ElementTable
+#include "elementtable.h"
+
 #endif // this file
 
@@ -21,10 +21,94 @@
  * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
+#include <sstream>
 #include <QTime>
 #include <QDir>
+#include <QFile>
+#include <QThread>
+#include <QtConcurrentMap>
 #include "elementdatabase.h"
 #include "xmlparser.h"
+#include "binaryparser.h"
+#include "staticelementtable.h"
+
+/// Maximum length of an element key, for the symbol index.
+static const int MAX_KEY_LENGTH = 32;
+
+/// Writes the key of a chemical element signature like 
+/// ElementDatabase::makeKey() does, without allocating memory.
+/// \param[in] e Chemical element signature.
+/// \param[out] key Receives the characters, not null terminated.
+/// \returns The length of the key or -1, if it exceeds MAX_KEY_LENGTH.
+static int 
+formatKey(const cfp::ChemicalElementInterface& e, char * key)
+{
+	int length = 0;
+	if (e.isIsotope()) {
+		// nucleon number in front of the symbol, e.g. 2H
+		char digits[MAX_KEY_LENGTH];
+		int count = 0;
+		for (int n = e.nucleons(); n > 0 && count < MAX_KEY_LENGTH; n /= 10) {
+			digits[count++] = char('0' + n % 10);
+		}
+		while (count > 0) key[length++] = digits[--count];
+	}
+	const std::string symbol(e.symbol());
+	if (length + int(symbol.size()) > MAX_KEY_LENGTH) return -1;
+	for (size_t i = 0; i < symbol.size(); i++) {
+		key[length++] = symbol[i];
+	}
+	return length;
+}
+
+/// 64 bit FNV-1a hash, see ElementDatabase::fingerprint(). Numbers are
+/// added most significant byte first, independent of the host.
+class Fnv1a
+{
+public:
+	/// Continues the hash \e hash.
+	explicit Fnv1a(quint64 hash): mHash(hash) {}
+
+	/// Returns the hash of all data added.
+	quint64 value() const { return mHash; }
+
+	/// Adds the bytes of an array.
+	void addBytes(const char * data, int size) {
+		for (int i = 0; i < size; i++) addByte(uchar(data[i]));
+	}
+	/// Adds a string and its terminating null character.
+	void addString(const char * str) {
+		if (str) addBytes(str, int(strlen(str)));
+		addByte(0);
+	}
+	/// Adds an integer.
+	void addInteger(quint64 value) {
+		for (int shift = 56; shift >= 0; shift -= 8) {
+			addByte(uchar(value >> shift));
+		}
+	}
+	/// Adds a double by its bits.
+	void addDouble(double value) {
+		quint64 bits;
+		memcpy(&bits, &value, sizeof(bits));
+		addInteger(bits);
+	}
+	/// Offset basis, the hash of no data.
+	static quint64 basis() { return Q_UINT64_C(14695981039346656037); }
+private:
+	void addByte(uchar c) {
+		mHash ^= quint64(c);
+		mHash *= Q_UINT64_C(1099511628211);
+	}
+	quint64 mHash;
+};
+
+ElementDatabase::ElementDatabase()
+	: mRevision(0), mSourceHash(Fnv1a::basis()), mFingerprint(0)
+{
+	updateFingerprint();
+}
 
 ElementDatabase::~ElementDatabase()
 {
@@ -33,13 +117,100 @@ ElementDatabase::~ElementDatabase()
 	}
 }
 
+/// Parses a single element data file in a worker thread of
+/// ElementDatabase::addFromDirectory(). The elements created are moved
+/// to the thread of the database afterwards.
+class ParseElementFile
+{
+public:
+	typedef XmlParser::ElementPtrList result_type;
+
+	ParseElementFile(QThread * target): mTarget(target) {}
+
+	result_type operator()(const QString& fn) const
+	{
+		XmlParser parser;
+		result_type list(parser.read(fn));
+		foreach(Element::Ptr ep, list) {
+			if (ep) ep->moveToThread(mTarget);
+		}
+		return list;
+	}
+private:
+	QThread * mTarget; //!< Thread the database lives in.
+};
+
 void 
 ElementDatabase::addFromFile(const QString& fn)
 {
 	XmlParser p;
-	foreach(Element::Ptr ep, p.read(fn)) {
-		if (ep.isNull() || !ep->isValid()) return;
-		mElementHash.insert(makeKey(*ep), ep);
+	addElements(p.read(fn));
+	buildIndex();
+	hashFile(fn);
+	updateFingerprint();
+}
+
+void 
+ElementDatabase::addElements(const XmlParser::ElementPtrList& list)
+{
+	foreach(Element::Ptr ep, list) {
+		if (!ep) continue;
+		if (!ep->isValid()) {
+			delete ep;
+			continue;
+		}
+		const KeyType key(makeKey(*ep));
+		// a replaced element passes its table row on
+		Element::Ptr old = mElementHash.value(key);
+		ep->moveTo(mTable, old ? old->id() : -1);
+		ep->setXrayGridPool(&mXrayGrids);
+		mElementHash.insert(key, ep);
+		delete old;
+		mRevision++;
+	}
+}
+
+void 
+ElementDatabase::linkIsotopes()
+{
+	foreach(Element::Ptr ep, mElementHash) {
+		if (!ep->isIsotope()) {
+			ep->setXrayElement(ep);
+			continue;
+		}
+		ep->setXrayElement(
+			mElementHash.value(KeyType(ep->symbol().c_str())));
+	}
+}
+
+void 
+ElementDatabase::buildIndex()
+{
+	linkIsotopes();
+	std::vector<std::string> keys;
+	std::vector<Element::ConstPtr> elements;
+	keys.reserve(mElementHash.size());
+	elements.reserve(mElementHash.size());
+	char key[MAX_KEY_LENGTH];
+	foreach(Element::Ptr ep, mElementHash) {
+		int length = formatKey(*ep, key);
+		if (length < 0) {
+			keys.clear();
+			break;
+		}
+		keys.push_back(std::string(key, length));
+		elements.push_back(ep);
+	}
+	mIndexedElements.clear();
+	if (keys.size() != size_t(mElementHash.size()) || 
+	    !mSymbolIndex.build(keys)) 
+	{
+		mSymbolIndex.build(std::vector<std::string>());
+		return;
+	}
+	mIndexedElements.resize(elements.size());
+	for (size_t i = 0; i < keys.size(); i++) {
+		mIndexedElements[mSymbolIndex.find(keys[i])] = elements[i];
 	}
 }
 
@@ -48,19 +219,102 @@ ElementDatabase::addFromDirectory(const QString& path)
 {
 	QTime timer;
 	timer.start();
-        QDir dir(path);
-        QStringList nameFilters;
-        nameFilters << "*.xml";
-        QStringList dirList = dir.entryList(nameFilters);
-        foreach(const QString file, dirList) {
-		addFromFile(path + "/" + file);
-        }
+	QDir dir(path);
+	QStringList nameFilters;
+	nameFilters << "*.xml";
+	QStringList fileList;
+	foreach(const QString file, dir.entryList(nameFilters)) {
+		fileList << path + "/" + file;
+	}
+	// parse all files in parallel, the results are ordered like the
+	// file list which keeps the database independent of the thread
+	// scheduling (later files override earlier ones, as before)
+	QList<XmlParser::ElementPtrList> results = QtConcurrent::mapped(
+		fileList, ParseElementFile(QThread::currentThread())).results();
+	foreach(const XmlParser::ElementPtrList& list, results) {
+		addElements(list);
+	}
+	buildIndex();
+	foreach(const QString& fn, fileList) {
+		hashFile(fn);
+	}
+	updateFingerprint();
 #if DEBUG
 	std::cerr << "element data directory read time: " 
 		<< timer.elapsed() << "ms" << std::endl;
 #endif
 }
 
+bool 
+ElementDatabase::addFromBinary(const QString& fn)
+{
+	QTime timer;
+	timer.start();
+	BinaryParser p;
+	const BinaryParser::ElementPtrList& list = p.read(fn);
+	if (list.empty()) return false;
+	addElements(list);
+	buildIndex();
+	Fnv1a hash(mSourceHash);
+	hash.addBytes(p.image().constData(), p.image().size());
+	mSourceHash = hash.value();
+	updateFingerprint();
+#if DEBUG
+	std::cerr << "element data image read time: " 
+		<< timer.elapsed() << "ms" << std::endl;
+#endif
+	return true;
+}
+
+void 
+ElementDatabase::addFromStaticTable(const StaticElementRecord * records,
+                                    int count)
+{
+	StaticElementTable t;
+	addElements(t.read(records, count));
+	buildIndex();
+	// the records, without the elements created from them
+	Fnv1a hash(mSourceHash);
+	for (int i = 0; i < count; i++) 
+	{
+		const StaticElementRecord& r = records[i];
+		hash.addString(r.symbol);
+		hash.addString(r.name);
+		hash.addInteger(quint64(r.nucleons));
+		hash.addInteger(quint64(r.electrons));
+		hash.addDouble(r.atomicMass);
+		hash.addDouble(r.abundance);
+		hash.addDouble(r.nslCoherent[0]);
+		hash.addDouble(r.nslCoherent[1]);
+		hash.addDouble(r.nslIncoherent[0]);
+		hash.addDouble(r.nslIncoherent[1]);
+		hash.addDouble(r.nsCsCoherent);
+		hash.addDouble(r.nsCsIncoherent);
+		hash.addDouble(r.nsCsTotal);
+		hash.addDouble(r.nsCsAbsorption);
+		hash.addInteger(quint64(r.xrayCount));
+		for (int j = 0; j < r.xrayCount; j++) {
+			hash.addDouble(r.xrayEnergy[j]);
+			hash.addDouble(r.xrayFp[j]);
+			hash.addDouble(r.xrayFpp[j]);
+		}
+		hash.addInteger(r.present);
+	}
+	mSourceHash = hash.value();
+	updateFingerprint();
+}
+
+void 
+ElementDatabase::hashFile(const QString& fn)
+{
+	QFile file(fn);
+	if (!file.open(QIODevice::ReadOnly)) return;
+	const QByteArray data(file.readAll());
+	Fnv1a hash(mSourceHash);
+	hash.addBytes(data.constData(), data.size());
+	mSourceHash = hash.value();
+}
+
 const 
 ElementDatabase::KeyType ElementDatabase::makeKey(const cfp::ChemicalElementInterface& e)
 {
@@ -68,16 +322,40 @@ ElementDatabase::KeyType ElementDatabase::makeKey(const cfp::ChemicalElementInte
 	return key;
 }
 
-Element::Ptr 
-ElementDatabase::getElement(const KeyType& key)
+Element::ConstPtr 
+ElementDatabase::getElement(const KeyType& key) const
 {
 	return mElementHash.value(key);
 }
 
-Element::Ptr 
-ElementDatabase::getElement(const cfp::ChemicalElementInterface& e)
+Element::ConstPtr 
+ElementDatabase::getElement(const cfp::ChemicalElementInterface& e) const
+{
+	char key[MAX_KEY_LENGTH];
+	int length = formatKey(e, key);
+	if (length < 0 || mSymbolIndex.size() != mElementHash.size()) {
+		// no index available
+		return mElementHash.value(makeKey(e));
+	}
+	return getElement(key, length);
+}
+
+Element::ConstPtr 
+ElementDatabase::getElement(const char * key, int length) const
+{
+	if (mSymbolIndex.size() != mElementHash.size()) {
+		// no index available
+		return mElementHash.value(QString::fromLatin1(key, length));
+	}
+	int i = mSymbolIndex.find(key, length);
+	if (i < 0) return NULL;
+	return mIndexedElements[i];
+}
+
+const ElementTable& 
+ElementDatabase::table() const
 {
-	return mElementHash.value(makeKey(e));
+	return mTable;
 }
 
 QStringList 
@@ -113,10 +391,18 @@ ElementDatabase::end() const
 	return mElementHash.constEnd();
 }
 
+ElementDatabase::Iterator 
+ElementDatabase::find(const KeyType& key) const
+{
+	return mElementHash.constFind(key);
+}
+
 void 
 ElementDatabase::addAlias(const KeyType& key, const cfp::Compound& compound)
 {
 	mAliasHash.insert(key, compound);
+	mRevision++;
+	updateFingerprint();
 }
 
 const cfp::Compound 
@@ -131,3 +417,31 @@ ElementDatabase::getAlias(const cfp::ChemicalElementInterface& e) const
 	return mAliasHash.value(makeKey(e));
 }
 
+int 
+ElementDatabase::revision() const
+{
+	return mRevision;
+}
+
+quint64 
+ElementDatabase::fingerprint() const
+{
+	return mFingerprint;
+}
+
+void 
+ElementDatabase::updateFingerprint()
+{
+	// the aliases sorted by name, independent of the hash order
+	Fnv1a hash(mSourceHash);
+	QStringList aliases(mAliasHash.keys());
+	aliases.sort();
+	foreach(const QString& key, aliases) {
+		std::stringstream ss;
+		ss << mAliasHash.value(key);
+		hash.addString(key.toUtf8().constData());
+		hash.addString(ss.str().c_str());
+	}
+	mFingerprint = hash.value();
+}
+
@@ -25,10 +25,15 @@
 #define EDB_ELEMENTDATABASE_H
 
 #include <QHash>
+#include <QPointer>
 #include <iostream>
 #include "element.h"
+#include "xmlparser.h"
+#include "elementtable.h"
+#include "symbolindex.h"
 
 class ElementDatabase;
+struct StaticElementRecord;
 
 /// Outputs the string representation of an element database to an
 /// output stream.
@@ -43,7 +48,10 @@ std::ostream& operator<<(std::ostream& o, const ElementDatabase& db);
  * cfp::Compound (for aliases). 
  *
  * The element datasets are not sorted in any way but can be retrieved
- * in constant time complexity.
+ * in constant time complexity. Lookups by chemical element signature 
+ * use a minimal perfect hash of all keys (SymbolIndex) which is rebuilt
+ * whenever elements are added, they do not allocate memory. Aliases are
+ * looked up in a regular hash table.
  *
  * \todo Combine single chemical elements and aliases (cfp::Compound)
  * into a single data type. Pro: aliases could be easily visualized in
@@ -77,6 +85,9 @@ public:
 	/// An iterator over the whole element database.
 	typedef ElementHash::const_iterator Iterator;
 public:
+	/// Creates an empty database.
+	ElementDatabase();
+
 	/// Cleanup, frees internal data.
 	~ElementDatabase();
 
@@ -87,18 +98,45 @@ public:
 	void addFromFile(const QString& fn);
 
 	/// Adds all elements from all XML files within the specified
-	/// directory to the database.
+	/// directory to the database. The files are parsed in parallel,
+	/// the result does not depend on the order in which they finish.
 	/// \param[in] path Full path to a directory which contains
 	///            XML files with chemical element definitions.
 	void addFromDirectory(const QString& path);
 
+	/// Adds all elements from a compiled binary database image.
+	/// \param[in] fn Filename or resource path of the image, see
+	///            BinaryParser for its layout.
+	/// \returns False if the image is missing, outdated or invalid,
+	///          nothing is added then. The XML data files can be read
+	///          by addFromDirectory() instead.
+	bool addFromBinary(const QString& fn);
+
+	/// Adds all elements from the element tables compiled into the
+	/// program, see StaticElementTable.
+	/// \param[in] records First record of the table.
+	/// \param[in] count Number of records.
+	void addFromStaticTable(const StaticElementRecord * records, int count);
+
 	/// Retrieves an element dataset with the specified key from
-	/// the database.
-	Element::Ptr getElement(const KeyType& key);
+	/// the database. Returns NULL if it is not found.
+	Element::ConstPtr getElement(const KeyType& key) const;
 
 	/// Retrieves an element dataset for the specified chemical
-	/// element signature from the database.
-	Element::Ptr getElement(const cfp::ChemicalElementInterface& e);
+	/// element signature from the database. Returns NULL if it is
+	/// not found.
+	Element::ConstPtr getElement(const cfp::ChemicalElementInterface& e) const;
+
+	/// Retrieves an element dataset by the characters of its key,
+	/// without allocating memory. Returns NULL if it is not found.
+	/// \param[in] key First character of the key, see KeyType. It does
+	///            not need to be null terminated.
+	/// \param[in] length Number of characters of \e key.
+	Element::ConstPtr getElement(const char * key, int length) const;
+
+	/// Returns the table of all element properties. The id of a row
+	/// is available by Element::id().
+	const ElementTable& table() const;
 
 	/// Generates a symbol list of all available elements in the
 	/// database.
@@ -111,6 +149,10 @@ public:
 	/// Returns an iterator to end with when interating over all elements.
 	Iterator end() const;
 
+	/// Returns an iterator to the element with the specified key or
+	/// end() if there is no such element.
+	Iterator find(const KeyType& key) const;
+
 	/// Generates a key based on the given chemical element
 	/// signature for retrieval of database elements.
 	/// \param[in] e Chemical element signature to generate a key for.
@@ -128,10 +170,55 @@ public:
 	/// element signature from the database.
 	const cfp::Compound getAlias(const cfp::ChemicalElementInterface& e) const;
 
+	/// Returns a number which changes whenever elements or aliases are
+	/// added. Results calculated from a different revision are outdated,
+	/// see ResultCache.
+	int revision() const;
+
+	/// Returns a 64 bit hash of all element data and aliases. It
+	/// identifies the content of the database across program runs, 
+	/// unlike revision(). It is calculated while loading, from the
+	/// source data in the order of loading: the XML files, the binary
+	/// image or the static tables. The elements are not read for it.
+	/// The same data loaded from a different source has a different
+	/// fingerprint.
+	quint64 fingerprint() const;
+
 	friend std::ostream& operator<<(std::ostream& o, const ElementDatabase& db);
 private:
+	/// Adds a list of parsed elements to the database and takes 
+	/// ownership of them. Invalid elements are skipped and deleted. An
+	/// element with the key of an existing one replaces and deletes it,
+	/// reusing its table row. The symbol index has to be rebuilt 
+	/// afterwards, see buildIndex().
+	void addElements(const XmlParser::ElementPtrList& list);
+
+	/// Rebuilds the perfect hash of all element keys. Lookups fall back
+	/// to the hash table mElementHash if it can not be built. Links
+	/// all isotopes to their natural elements, see linkIsotopes().
+	void buildIndex();
+
+	/// Sets Element::xrayElement() of all elements: isotopes refer to
+	/// the natural element with the same symbol, all others to
+	/// themselves.
+	void linkIsotopes();
+
+	/// Adds the content of a loaded file to mSourceHash.
+	void hashFile(const QString& fn);
+
+	/// Calculates mFingerprint from mSourceHash and all aliases.
+	void updateFingerprint();
+private:
+	ElementTable mTable;      //!< Properties of all elements.
+	XrayGridPool mXrayGrids;  //!< Energy grids shared by all elements.
 	ElementHash mElementHash; //!< Hash table for chemical element datasets.
+	SymbolIndex mSymbolIndex; //!< Perfect hash of all element keys.
+	/// Elements by their index in mSymbolIndex.
+	std::vector<Element::ConstPtr> mIndexedElements;
 	AliasHash   mAliasHash;   //!< Hash table for compound aliases.
+	int         mRevision;    //!< See revision().
+	quint64     mSourceHash;  //!< Hash of all loaded data.
+	quint64     mFingerprint; //!< See fingerprint().
 };
 
 #endif
@@ -0,0 +1,241 @@
+/*
+ * src/elementtable.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "elementtable.h"
+
+/// Writes a property value to its typed column.
+class SetColumnValue: public boost::static_visitor<void>
+{
+	std::vector< std::vector<int> >&         mInts;
+	std::vector< std::vector<std::string> >& mStrings;
+	std::vector< std::vector<double> >&      mDoubles;
+	std::vector< std::vector<complex> >&     mComplexes;
+	int mColumn;
+	ElementTable::Id mId;
+public:
+	SetColumnValue(std::vector< std::vector<int> >& i,
+	               std::vector< std::vector<std::string> >& s,
+	               std::vector< std::vector<double> >& d,
+	               std::vector< std::vector<complex> >& c,
+	               int column, ElementTable::Id id)
+		: mInts(i), mStrings(s), mDoubles(d), mComplexes(c),
+		  mColumn(column), mId(id)
+	{}
+	void operator()(const int& i) const         { mInts[mColumn][mId] = i; }
+	void operator()(const std::string& s) const { mStrings[mColumn][mId] = s; }
+	void operator()(const double& d) const      { mDoubles[mColumn][mId] = d; }
+	void operator()(const complex& c) const     { mComplexes[mColumn][mId] = c; }
+};
+
+ElementTable::ElementTable()
+{
+	for(int i=0; i < Element::propertyCount(); i++)
+	{
+		Element::Property p = Element::getProperty(i);
+		switch(Element::propertyType(p)) {
+			case Element::INT_TYPE:
+				mColumn[p] = int(mIntColumns.size());
+				mIntColumns.push_back(std::vector<int>());
+				break;
+			case Element::STRING_TYPE:
+				mColumn[p] = int(mStringColumns.size());
+				mStringColumns.push_back(std::vector<std::string>());
+				break;
+			case Element::DOUBLE_TYPE:
+				mColumn[p] = int(mDoubleColumns.size());
+				mDoubleColumns.push_back(std::vector<double>());
+				break;
+			case Element::COMPLEX_TYPE:
+				mColumn[p] = int(mComplexColumns.size());
+				mComplexColumns.push_back(std::vector<complex>());
+				break;
+			default:
+				mColumn[p] = -1;
+				break;
+		}
+	}
+}
+
+int
+ElementTable::size() const
+{
+	return int(mDataMask.size());
+}
+
+ElementTable::Id
+ElementTable::addRow()
+{
+	for(size_t i=0; i < mIntColumns.size(); i++)
+		mIntColumns[i].push_back(0);
+	for(size_t i=0; i < mStringColumns.size(); i++)
+		mStringColumns[i].push_back(std::string());
+	for(size_t i=0; i < mDoubleColumns.size(); i++)
+		mDoubleColumns[i].push_back(0.0);
+	for(size_t i=0; i < mComplexColumns.size(); i++)
+		mComplexColumns[i].push_back(complex());
+	mDataMask.push_back(0);
+	return Id(mDataMask.size() - 1);
+}
+
+ElementTable::Id
+ElementTable::addRow(const ElementTable& src, Id srcId)
+{
+	// both tables have the same layout
+	for(size_t i=0; i < mIntColumns.size(); i++)
+		mIntColumns[i].push_back(src.mIntColumns[i][srcId]);
+	for(size_t i=0; i < mStringColumns.size(); i++)
+		mStringColumns[i].push_back(src.mStringColumns[i][srcId]);
+	for(size_t i=0; i < mDoubleColumns.size(); i++)
+		mDoubleColumns[i].push_back(src.mDoubleColumns[i][srcId]);
+	for(size_t i=0; i < mComplexColumns.size(); i++)
+		mComplexColumns[i].push_back(src.mComplexColumns[i][srcId]);
+	mDataMask.push_back(src.mDataMask[srcId]);
+	return Id(mDataMask.size() - 1);
+}
+
+void
+ElementTable::copyRow(Id id, const ElementTable& src, Id srcId)
+{
+	for(size_t i=0; i < mIntColumns.size(); i++)
+		mIntColumns[i][id] = src.mIntColumns[i][srcId];
+	for(size_t i=0; i < mStringColumns.size(); i++)
+		mStringColumns[i][id] = src.mStringColumns[i][srcId];
+	for(size_t i=0; i < mDoubleColumns.size(); i++)
+		mDoubleColumns[i][id] = src.mDoubleColumns[i][srcId];
+	for(size_t i=0; i < mComplexColumns.size(); i++)
+		mComplexColumns[i][id] = src.mComplexColumns[i][srcId];
+	mDataMask[id] = src.mDataMask[srcId];
+}
+
+bool
+ElementTable::hasValue(Element::Property p, Id id) const
+{
+	if (p < 0 || p >= Element::INVALID_PROPERTY ||
+	    id < 0 || id >= size()) return false;
+	return (mDataMask[id] & (1u << p)) != 0;
+}
+
+Element::PropertyVariant
+ElementTable::value(Element::Property p, Id id) const
+{
+	if (hasValue(p, id)) {
+		const int col = mColumn[p];
+		switch(Element::propertyType(p)) {
+			case Element::INT_TYPE:     return mIntColumns[col][id];
+			case Element::STRING_TYPE:  return mStringColumns[col][id];
+			case Element::DOUBLE_TYPE:  return mDoubleColumns[col][id];
+			case Element::COMPLEX_TYPE: return mComplexColumns[col][id];
+			default: break;
+		}
+	}
+	return Element::INVALID_PROPERTY_VALUE;
+}
+
+int
+ElementTable::column(Element::Property p, Element::PropertyType type) const
+{
+	if (p < 0 || p >= Element::INVALID_PROPERTY ||
+	    Element::propertyType(p) != type) return -1;
+	return mColumn[p];
+}
+
+bool
+ElementTable::get(Element::Property p, Id id, int& val) const
+{
+	const int col = column(p, Element::INT_TYPE);
+	if (col < 0 || !hasValue(p, id)) return false;
+	val = mIntColumns[col][id];
+	return true;
+}
+
+bool
+ElementTable::get(Element::Property p, Id id, std::string& val) const
+{
+	const int col = column(p, Element::STRING_TYPE);
+	if (col < 0 || !hasValue(p, id)) return false;
+	val = mStringColumns[col][id];
+	return true;
+}
+
+bool
+ElementTable::get(Element::Property p, Id id, double& val) const
+{
+	const int col = column(p, Element::DOUBLE_TYPE);
+	if (col < 0 || !hasValue(p, id)) return false;
+	val = mDoubleColumns[col][id];
+	return true;
+}
+
+bool
+ElementTable::get(Element::Property p, Id id, complex& val) const
+{
+	const int col = column(p, Element::COMPLEX_TYPE);
+	if (col < 0 || !hasValue(p, id)) return false;
+	val = mComplexColumns[col][id];
+	return true;
+}
+
+bool
+ElementTable::setValue(Element::Property p, Id id,
+                       const Element::PropertyVariant& var)
+{
+	if (id < 0 || id >= size() ||
+	    !Element::isValidType(p, var)) return false;
+	boost::apply_visitor(SetColumnValue(mIntColumns, mStringColumns,
+		mDoubleColumns, mComplexColumns, mColumn[p], id), var);
+	mDataMask[id] |= (1u << p);
+	return true;
+}
+
+const std::vector<int>&
+ElementTable::intColumn(Element::Property p) const
+{
+	static const std::vector<int> empty;
+	const int col = column(p, Element::INT_TYPE);
+	return (col < 0) ? empty : mIntColumns[col];
+}
+
+const std::vector<std::string>&
+ElementTable::stringColumn(Element::Property p) const
+{
+	static const std::vector<std::string> empty;
+	const int col = column(p, Element::STRING_TYPE);
+	return (col < 0) ? empty : mStringColumns[col];
+}
+
+const std::vector<double>&
+ElementTable::doubleColumn(Element::Property p) const
+{
+	static const std::vector<double> empty;
+	const int col = column(p, Element::DOUBLE_TYPE);
+	return (col < 0) ? empty : mDoubleColumns[col];
+}
+
+const std::vector<complex>&
+ElementTable::complexColumn(Element::Property p) const
+{
+	static const std::vector<complex> empty;
+	const int col = column(p, Element::COMPLEX_TYPE);
+	return (col < 0) ? empty : mComplexColumns[col];
+}
+
@@ -0,0 +1,149 @@
+/*
+ * src/elementtable.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EDB_ELEMENTTABLE_H
+#define EDB_ELEMENTTABLE_H
+
+#include <vector>
+#include <string>
+#include "element.h"
+
+/**
+ * Column-oriented storage of the properties of many elements. Each
+ * Element::Property is stored in a contiguous array of its
+ * Element::PropertyType, indexed by a dense row id. An Element is a view
+ * of a single row.
+ *
+ * Scans over a property of all elements are linear passes over a single
+ * array, see intColumn(), doubleColumn() etc. Rows are never removed,
+ * ids stay valid for the lifetime of the table.
+ */
+class ElementTable
+{
+public:
+	/// Dense index of a row, starting at 0.
+	typedef int Id;
+public:
+	ElementTable(); //!< Creates an empty table.
+
+	/// Returns the number of rows.
+	int size() const;
+
+	/// Appends a new row without any property data.
+	/// \returns The id of the new row.
+	Id addRow();
+
+	/// Appends a copy of a row of another table.
+	/// \returns The id of the new row.
+	Id addRow(const ElementTable& src, Id srcId);
+
+	/// Overwrites an existing row by a copy of a row of another table.
+	void copyRow(Id id, const ElementTable& src, Id srcId);
+
+	/// Tests if a property of a row was set.
+	bool hasValue(Element::Property p, Id id) const;
+
+	/// Returns the value of a property as variant. It is
+	/// Element::INVALID_PROPERTY_VALUE if the property was not set.
+	Element::PropertyVariant value(Element::Property p, Id id) const;
+
+	/// Reads the value of a property.
+	/// \returns False if the property was not set or has another type,
+	///          \e val is unchanged then.
+	bool get(Element::Property p, Id id, int& val) const;
+	/// \copydoc get(Element::Property, Id, int&) const
+	bool get(Element::Property p, Id id, std::string& val) const;
+	/// \copydoc get(Element::Property, Id, int&) const
+	bool get(Element::Property p, Id id, double& val) const;
+	/// \copydoc get(Element::Property, Id, int&) const
+	bool get(Element::Property p, Id id, complex& val) const;
+
+	/// Reads the value of a property with the type determined at 
+	/// compile time, see Element::PropertyTraits. Unlike the other 
+	/// get() methods, neither the type nor \e id are checked.
+	/// \returns False if the property was not set, \e val is unchanged
+	///          then.
+	template<Element::Property P>
+	bool get(Id id, typename Element::PropertyTraits<P>::ValueType& val) const
+	{
+		if (!(mDataMask[id] & (1u << P))) return false;
+		val = columns(&val)[mColumn[P]][id];
+		return true;
+	}
+
+	/// Sets a property to the provided value. The type of the value
+	/// has to match Element::propertyType().
+	/// \returns False if the types do not match.
+	bool setValue(Element::Property p, Id id,
+	              const Element::PropertyVariant& var);
+
+	/// Returns all values of a property of Element::INT_TYPE, indexed
+	/// by row id. Values of rows without data are undefined, see
+	/// hasValue(). Empty for properties of other types.
+	const std::vector<int>& intColumn(Element::Property p) const;
+	/// \copydoc intColumn() for Element::STRING_TYPE.
+	const std::vector<std::string>& stringColumn(Element::Property p) const;
+	/// \copydoc intColumn() for Element::DOUBLE_TYPE.
+	const std::vector<double>& doubleColumn(Element::Property p) const;
+	/// \copydoc intColumn() for Element::COMPLEX_TYPE.
+	const std::vector<complex>& complexColumn(Element::Property p) const;
+private:
+	/// Index of the column of a property within the columns of its
+	/// type, -1 if the property has no valid type.
+	int column(Element::Property p, Element::PropertyType type) const;
+
+	/// Returns the columns of a value type, selected by the type of 
+	/// the unused argument.
+	const std::vector< std::vector<int> >& columns(const int *) const
+	{ return mIntColumns; }
+	/// \copydoc columns(const int *) const
+	const std::vector< std::vector<std::string> >& columns(const std::string *) const
+	{ return mStringColumns; }
+	/// \copydoc columns(const int *) const
+	const std::vector< std::vector<double> >& columns(const double *) const
+	{ return mDoubleColumns; }
+	/// \copydoc columns(const int *) const
+	const std::vector< std::vector<complex> >& columns(const complex *) const
+	{ return mComplexColumns; }
+private:
+	/// Column index of each property, see column().
+	int mColumn[Element::INVALID_PROPERTY];
+	std::vector< std::vector<int> >         mIntColumns;    //!< Integers.
+	std::vector< std::vector<std::string> > mStringColumns; //!< Strings.
+	std::vector< std::vector<double> >      mDoubleColumns; //!< Floats.
+	std::vector< std::vector<complex> >     mComplexColumns;//!< Complex.
+	/// Per row, one bit for each property which was set.
+	std::vector<unsigned int> mDataMask;
+};
+
+template<Element::Property P>
+typename Element::PropertyTraits<P>::ValueType 
+Element::get() const
+{
+	typedef typename PropertyTraits<P>::ValueType ValueType;
+	ValueType val = ValueType();
+	if (!mTable->get<P>(mId, val)) return defaultValue(ValueType(), P);
+	return val;
+}
+
+#endif
@@ -26,8 +26,10 @@
 #include "utils.h"
 #include "inputdata.h"
  
-InputData::InputData(ElementDatabase& db)
-	: mDB(&db)
+InputData::InputData(const ElementDatabase& db)
+	: mDB(&db),
+	  mCache(0),
+	  mResultRevision(-1)
 {
 }
 
@@ -52,16 +54,7 @@ InputData::getInit(const QString& key) const { return get(mInitData, key); }
 const cfp::Compound& 
 InputData::empiricalFormula() const
 {
-	return mFormulaParser.empirical();
-}
-
-void 
-InputData::addAlias(const QString& name)
-{
-	mDB->addAlias(name, empiricalFormula());
-//	Element newElem;
-//	newElem.setProperty<int>(Element::ELECTRONS_PROPERTY,
-//	                         get("number of electrons").toInt());
+	return mCompound.formula();
 }
 
 void 
@@ -74,35 +67,77 @@ InputData::interpretFormula(const QString& formulaKey)
 	}
 #endif
 	QByteArray formula(var.toByteArray());
+	// parse only if the formula or the elements changed
+	if (formula != mCompoundText || 
+	    mCompound.revision() != mDB->revision()) 
+	{
+		// may throw an exception
+		compile(formula, mCompound);
+		mCompoundText = formula;
+	}
+	set(formulaKey, QVariant(QString::fromStdString(mCompound.empirical())));
+	calcData(mCompound);
+}
+
+void 
+InputData::calculate(const QByteArray& formula, CalcResult& r)
+{
+	compile(formula, mRowCompound);
+	evaluate(mRowCompound, r);
+}
+
+void 
+InputData::compile(const QByteArray& formula, CompiledCompound& compound)
+{
 	// may throw an exception
 	mFormulaParser.process(formula.data(), formula.length());
+	CompiledCompound::EntryList entries;
+	buildEntryList(entries, mFormulaParser.empirical());
 
 	std::stringstream ss;
 	ss << mFormulaParser.empirical();
-	set(formulaKey, QVariant(QString::fromStdString(ss.str())));
+	compound.mEntries.swap(entries);
+	compound.mFormula = mFormulaParser.empirical();
+	compound.mEmpirical = ss.str();
+	compound.mRevision = mDB->revision();
+}
 
-	CompleteList elemList;
-	buildCompleteList(elemList, mFormulaParser.empirical());
+void 
+InputData::evaluate(const CompiledCompound& compound, CalcResult& r) const
+{
+	calcCached(compound, r);
 }
 
 void 
-InputData::buildCompleteList(CompleteList& list, const cfp::Compound& comp)
+InputData::setResultCache(ResultCache * cache)
+{
+	mCache = cache;
+}
+
+void 
+InputData::buildEntryList(CompiledCompound::EntryList& list, 
+                          const cfp::Compound&         comp) const
 {
 	foreach(cfp::CompoundElement e, comp) 
 	{
-		Element::Ptr ep = mDB->getElement(e);
-		if (!ep.isNull()) {
-			list.append(ElemPair(e, ep));
+		Element::ConstPtr ep = mDB->getElement(e);
+		if (ep) {
+			CompiledCompound::Entry entry;
+			entry.element = ep;
+			entry.xrayElement = ep->xrayElement();
+			entry.id = ep->id();
+			entry.coefficient = e.coefficient();
+			entry.name = e.uniqueName();
+			list.push_back(entry);
 		} else {
 			const cfp::Compound subComp = mDB->getAlias(e);
 			if (subComp.size() > 0) {
-				buildCompleteList(list, subComp);
+				buildEntryList(list, subComp);
 			} else {
 				throw ErrorUnknownElement(e);
 			}
 		}
 	}
-	calcData(list);
 }
 
 void 
@@ -114,100 +149,58 @@ addComplex2Map(QVariantMap& map, const char * key, complex c)
 	map.insert(key, QVariant(list));
 }
 
-double 
-InputData::calcElectrons(const CompleteList& cl,
-                         QVariantMap&        partialElectrons)
+void 
+InputData::calcElectrons(const CompiledCompound& cl, CalcResult& r) const
 {
-	double totalElectrons = 0.0;
-	CompleteList::const_iterator it = cl.begin();
-	for(;it != cl.end(); it++) {
-		QString name(it->first.uniqueName().c_str());
-		double electrons = 
-			(it->first.coefficient() * it->second->electrons());
-		partialElectrons.insert(name, QVariant(electrons));
-		totalElectrons += electrons;
+	r.electrons = 0.0;
+	for(int i = 0; i < cl.size(); i++) {
+		const CompiledCompound::Entry& e = cl.at(i);
+		double electrons = (e.coefficient * e.element->electrons());
+		r.partials[i].electrons = electrons;
+		r.electrons += electrons;
 	}
-	partialElectrons.insert("value", QVariant(totalElectrons));
-	set("number of electrons", QVariant(partialElectrons));
-	return totalElectrons;
 }
 
 void 
-InputData::calcMassAndVolume(const CompleteList& cl,
-                             QVariantMap&        partialVolume,
-                             double&             totalMass,
-                             double&             totalVolume)
+InputData::calcMassAndVolume(const CompiledCompound& cl, CalcResult& r) const
 {
-	QVariantMap partialMass;
-	double compoundDensity = get("ntrDensity").toDouble();
-	totalMass = 0.0;
-	totalVolume = 0.0;
-	CompleteList::const_iterator it = cl.begin();
-	for(;it != cl.end(); it++) {
+	r.mass = 0.0;
+	r.volume = 0.0;
+	for(int i = 0; i < cl.size(); i++) {
+		const CompiledCompound::Entry& e = cl.at(i);
+		CalcResult::Partial& p = r.partials[i];
 		// calculate partial values
-		double weight = (it->first.coefficient() * it->second->atomicMass());
-		double volume = 1e-2 * weight / (avogadro() * compoundDensity);
-
-		// create element name from nucleon number and symbol
-		QString name(it->first.uniqueName().c_str());
-
-		// add partial values to result and calculate total value
-		partialMass.insert(name, QVariant(weight));
-		totalMass += weight;
-		partialVolume.insert(name, QVariant(volume));
-		totalVolume += volume;
+		p.mass = (e.coefficient * e.element->atomicMass());
+		p.volume = 1e-2 * p.mass / (avogadro() * r.density);
+		r.mass += p.mass;
+		r.volume += p.volume;
 	}
 
 	// volume ratios do not make sense here, as the density is entered manually
 
 	// calculate mass percentages
-	QVariantMap massComposition;
-	QVariantMap::const_iterator mit = partialMass.constBegin();
-	while(mit != partialMass.constEnd()) {
-		double percentage = 100.0 * mit.value().toDouble()/totalMass;
-		massComposition.insert(mit.key(), QVariant(percentage));
-		mit++;
+	for(size_t i = 0; i < r.partials.size(); i++) {
+		r.partials[i].massRatio = 100.0 * r.partials[i].mass / r.mass;
 	}
-
-	QVariantMap masses;
-	masses.insert("value", QVariant(totalMass));
-	masses.insert("partial masses g/mol", QVariant(partialMass));
-	masses.insert("mass ratios %", QVariant(massComposition));
-	set("molecular mass g/mol", QVariant(masses));
-
-	partialVolume.insert("value", QVariant(totalVolume));
-	set("molecular volume nm^3", QVariant(partialVolume));
 }
 
 void 
-InputData::calcNSL(const CompleteList& cl, 
-                   double              totalVolume,
-                   QVariantMap&        neutron,
-                   complex (Element::*func)(void) const,
-                   const char        * slText,
-                   const char        * sldText)
+InputData::calcNSL(const CompiledCompound& cl, CalcResult& r) const
 {
-	complex totalSL(0.0, 0.0);
-	complex totalSLD(0.0, 0.0);
-	QVariantMap partialSLD;
-	CompleteList::const_iterator it = cl.begin();
-	for(;it != cl.end(); it++) {
-		complex sl = (it->first.coefficient() * ((*it->second).*func)());
-		complex sld = 1e8 * (sl / totalVolume);
-		addComplex2Map(partialSLD, it->first.uniqueName().c_str(), sld);
-		totalSL += sl;
-		totalSLD += sld;
+	r.nslCoherent = r.nslIncoherent = complex(0.0, 0.0);
+	r.sldCoherent = r.sldIncoherent = complex(0.0, 0.0);
+	for(int i = 0; i < cl.size(); i++) {
+		const CompiledCompound::Entry& e = cl.at(i);
+		CalcResult::Partial& p = r.partials[i];
+		p.nslCoherent = e.coefficient * e.element->nslCoherent();
+		p.nslIncoherent = e.coefficient * e.element->nslIncoherent();
+		p.sldCoherent = 1e8 * (p.nslCoherent / r.volume);
+		p.sldIncoherent = 1e8 * (p.nslIncoherent / r.volume);
+		r.nslCoherent += p.nslCoherent;
+		r.nslIncoherent += p.nslIncoherent;
+		r.sldCoherent += p.sldCoherent;
+		r.sldIncoherent += p.sldIncoherent;
 	}
-
-	addComplex2Map(partialSLD, "value", totalSLD);
-	addComplex2Map(neutron, slText, totalSL);
-	neutron.insert(sldText, partialSLD);
-}
-
-double 
-interpolate(double x1, double y1, double x2, double y2, double x3)
-{
-	return (x3-x1) * (y2-y1)/(x2-x1) + y1;
 }
 
 complex 
@@ -220,78 +213,38 @@ sldXray(double electrons, double fp, double fpp, double vol)
 	return sld;
 }
 
-bool 
-InputData::calcXrayCoefficients(double&           fp, 
-                                double&           fpp,
-                                Element::Ptr ep,
-                                double            coeff,
-                                double            energy)
+XraySpan::Status 
+InputData::calcXrayCoefficients(double&        fp, 
+                                double&        fpp,
+                                const Element& e,
+                                double         coeff,
+                                double         energy) const
 {
-	typedef MapTriple::const_iterator Iter;
-	Iter end = ep->xrayCoefficients().end();
-	Iter begin = ep->xrayCoefficients().begin();
-	Iter it = ep->xrayCoefficients().find(energy);
-	fp = 0.0, fpp = 0.0;
-	// energy already in the map
-	if (it != end) {
-		fp = (coeff * it->second.first);
-		fpp = (coeff * it->second.second);
-	} else {
-		// interpolate missing energy
-		ep->addXrayCoefficient(energy, 0.0, 0.0);
-		it = ep->xrayCoefficients().find(energy);
-		Iter prev = it; prev--;
-		Iter next = it; next++;
-		if (it != end && it != begin && next != end) {
-			double prevEn = prev->first;
-			double nextEn = next->first;
-
-			double prevFp = prev->second.first;
-			double nextFp = next->second.first;
-			fp  = interpolate(prevEn, prevFp, 
-					  nextEn, nextFp, energy);
-			double prevFpp = prev->second.second;
-			double nextFpp = next->second.second;
-			fpp = interpolate(prevEn, prevFpp,
-					  nextEn, nextFpp, energy);
-		} else {
-			// given xray energy is out of range
-			// (of values in the map)
-			return false;
-		}
-	}
-	return true;
+	XraySpan::Status status = e.xrayCoefficientsAt(energy, fp, fpp);
+	fp *= coeff;
+	fpp *= coeff;
+	return status;
 }
 
 void 
-InputData::calcXrayEnergies(const CompleteList& cl,
-                            const QVariantMap& partialVolumes,
-                            const QVariantMap& partialElectrons)
+InputData::calcXrayEnergies(const CompiledCompound& cl, CalcResult& r) const
 {
-	QVariantMap xray, partialFp, partialFpp, partialSLD;
-	double energy = 1000.0 * get("ntrXrayEn").toDouble();
-	double totalFp = 0.0, totalFpp = 0.0;
-
-	if (!partialVolumes.contains("value")) return;
-	if (!partialElectrons.contains("value")) return;
-	double totalVolume = 1e-8 * partialVolumes.value("value").toDouble();
-	double totalElectrons = partialElectrons.value("value").toDouble();
-
-	CompleteList::const_iterator elemIt = cl.begin();
-	for(;elemIt != cl.end(); elemIt++) 
+	r.clearXray();
+	for(int i = 0; i < cl.size(); i++) 
 	{
-		Element::Ptr ep = elemIt->second;
-		if (ep->isIsotope()) {
-			ep = mDB->getElement(ElementDatabase::KeyType(ep->symbol().c_str()));
-			if (ep.isNull())
-			{
+		const CompiledCompound::Entry& elem = cl.at(i);
+		CalcResult::Partial& p = r.partials[i];
+		const Element * ep = elem.xrayElement;
+		if (!ep)
+		{
 #ifdef DEBUG
-				std::cerr << "InputData::calcXrayEnergies: '"
-					<< ep->symbol().c_str()
-					<<"' not found in Database !" << std::endl;
+			std::cerr << "InputData::calcXrayEnergies: '"
+				<< elem.element->symbol().c_str()
+				<<"' not found in Database !" << std::endl;
 #endif
-				return; // avoid invalid value output
-			}
+			// avoid invalid value output, drop the elements done so far
+			r.clearXray();
+			return;
 		}
 		if (ep->xrayCoefficients().size() < 2)
 		{
@@ -302,68 +255,341 @@ InputData::calcXrayEnergies(const CompleteList& cl,
 #endif
 			continue;
 		}
-		double fp = 0.0, fpp = 0.0;
-		bool ok = calcXrayCoefficients(fp, fpp, ep, 
-		                        elemIt->first.coefficient(), energy);
-		if (!ok) {
+		XraySpan::Status status = calcXrayCoefficients(p.fp, p.fpp, *ep, 
+		                        elem.coefficient, r.xrayEnergy);
+		if (status != XraySpan::EXACT && 
+		    status != XraySpan::INTERPOLATED) 
+		{
 #ifdef DEBUG
 			std::cerr << "InputData::calcXrayEnergies, "
-				<< "Specified energy is out of bounds!"
+				<< "Specified energy is "
+				<< (status == XraySpan::BELOW_RANGE ? "below" : "above")
+				<< " the tabulated range!"
 				<< std::endl;
 #endif
+			r.clearXray();
+			r.xrayStatus = status;
 			return;
 		}
-
-		// create element name from nucleon number and symbol
-		std::string nameStd = elemIt->first.uniqueName();
-		QString name = QString::fromStdString(nameStd);
-		// store partial xray scattering coefficients
-		partialFp.insert(name, QVariant(fp));
-		totalFp += fp;
-		partialFpp.insert(name, QVariant(fpp));
-		totalFpp += fpp;
-
-		// calculate partial SLDs
-		if (partialVolumes.contains(name)) {
-			double volume = 1e-8 * partialVolumes.value(name).toDouble();
-			double electrons = elemIt->first.coefficient() * ep->electrons();
-			complex sld = sldXray(electrons, fp, fpp, volume);
-			addComplex2Map(partialSLD, nameStd.c_str(), sld);
-		} else {
-#ifdef DEBUG
-			std::cerr << "partialVolumes empty!" << std::endl;
-#endif
+		if (status == XraySpan::INTERPOLATED || 
+		    r.xrayStatus == XraySpan::NO_DATA) 
+		{
+			r.xrayStatus = status;
 		}
 
+		// partial scattering coefficients
+		p.hasXray = true;
+		r.fp += p.fp;
+		r.fpp += p.fpp;
 	} // end for each element in list
-	partialFp.insert("value", QVariant(totalFp));
-	partialFpp.insert("value", QVariant(totalFpp));
+	calcXraySld(r);
+}
+
+void 
+InputData::calcXraySld(CalcResult& r) const
+{
+	r.sldXray = complex(0.0, 0.0);
+	if (!r.hasXray()) return;
+	for(size_t i = 0; i < r.partials.size(); i++) {
+		CalcResult::Partial& p = r.partials[i];
+		if (!p.hasXray) continue;
+		// isotopes have the electrons of their element
+		p.sldXray = sldXray(p.electrons, p.fp, p.fpp, 1e-8 * p.volume);
+	}
+	r.sldXray = sldXray(r.electrons, r.fp, r.fpp, 1e-8 * r.volume);
+}
+
+void 
+InputData::calcResult(const CompiledCompound& cl, CalcResult& r, 
+                      int stages) const
+{
+	if (stages & STAGE_COMPOSITION) {
+		r.clear();
+		r.partials.resize(cl.size());
+		for(int i = 0; i < cl.size(); i++) {
+			r.partials[i].name = cl.at(i).name;
+		}
+		calcElectrons(cl, r);
+	}
+	if (stages & STAGE_VOLUME) {
+		calcMassAndVolume(cl, r);
+		calcNSL(cl, r);
+	}
+	if (stages & STAGE_NEUTRON) {
+		calcNeutronCrossSections(cl, r);
+	}
+	if (stages & STAGE_XRAY) {
+		calcXrayEnergies(cl, r);
+	} else if (stages & STAGE_VOLUME) {
+		calcXraySld(r);
+	}
+}
+
+void 
+InputData::calcData(const CompiledCompound& cl)
+{
+	double density = get("ntrDensity").toDouble();
+	double energy = 1000.0 * get("ntrXrayEn").toDouble();
+	double wavelength = get("ntrNeutronWl").toDouble();
+
+	// stages invalidated by changed input
+	int stages = 0;
+	if (cl.empirical() != mResultFormula || 
+	    mDB->revision() != mResultRevision) 
+	{
+		stages = STAGE_ALL;
+	}
+	if (density != mResult.density) stages |= STAGE_VOLUME | STAGE_NEUTRON;
+	if (wavelength != mResult.neutronWavelength) stages |= STAGE_NEUTRON;
+	if (energy != mResult.xrayEnergy) stages |= STAGE_XRAY;
+
+	mResult.density = density;
+	mResult.xrayEnergy = energy;
+	mResult.neutronWavelength = wavelength;
+	mResultFormula = cl.empirical();
+	mResultRevision = mDB->revision();
+	if (stages) calcCached(cl, mResult, stages);
+
+	storeResult(mResult);
+}
+
+void 
+InputData::calcCached(const CompiledCompound& cl, 
+                      CalcResult&             r,
+                      int                     stages) const
+{
+	if (!mCache) {
+		calcResult(cl, r, stages);
+		return;
+	}
+	mCache->setRevision(mDB->revision());
+	QByteArray key(ResultCache::makeKey(cl.empirical(), r));
+	if (mCache->find(key, r)) return;
+	calcResult(cl, r, stages);
+	mCache->insert(key, r);
+}
+
+void 
+InputData::storeResult(const CalcResult& r)
+{
+	QVariantMap electrons, masses, partialMass, massComposition, volumes;
+	QVariantMap neutron, sldCoherent, sldIncoherent;
+	QVariantMap xray, partialFp, partialFpp, sldXray;
+	std::vector<CalcResult::Partial>::const_iterator it = r.partials.begin();
+	for(;it != r.partials.end(); it++)
+	{
+		QString name(it->name.c_str());
+		electrons.insert(name, QVariant(it->electrons));
+		partialMass.insert(name, QVariant(it->mass));
+		massComposition.insert(name, QVariant(it->massRatio));
+		volumes.insert(name, QVariant(it->volume));
+		addComplex2Map(sldCoherent, it->name.c_str(), it->sldCoherent);
+		addComplex2Map(sldIncoherent, it->name.c_str(), it->sldIncoherent);
+		if (it->hasXray) {
+			partialFp.insert(name, QVariant(it->fp));
+			partialFpp.insert(name, QVariant(it->fpp));
+			addComplex2Map(sldXray, it->name.c_str(), it->sldXray);
+		}
+	}
+
+	electrons.insert("value", QVariant(r.electrons));
+	set("number of electrons", QVariant(electrons));
+
+	masses.insert("value", QVariant(r.mass));
+	masses.insert("partial masses g/mol", QVariant(partialMass));
+	masses.insert("mass ratios %", QVariant(massComposition));
+	set("molecular mass g/mol", QVariant(masses));
+
+	volumes.insert("value", QVariant(r.volume));
+	set("molecular volume nm^3", QVariant(volumes));
+
+	addComplex2Map(neutron, "coherent scattering length 1e-15m", r.nslCoherent);
+	addComplex2Map(sldCoherent, "value", r.sldCoherent);
+	neutron.insert("SLD coherent 1/cm^2", sldCoherent);
+	addComplex2Map(neutron, "incoherent scattering length 1e-15m", r.nslIncoherent);
+	addComplex2Map(sldIncoherent, "value", r.sldIncoherent);
+	neutron.insert("SLD incoherent 1/cm^2", sldIncoherent);
+	if (r.hasCrossSections) {
+		neutron.insert("absorption cross section 1/cm", QVariant(r.absorption));
+		neutron.insert("incoherent cross section 1/cm", QVariant(r.incoherent));
+		neutron.insert("total cross section 1/cm", QVariant(r.total));
+		neutron.insert("transmission of 1 mm", QVariant(r.transmission));
+	}
+	set("neutron scattering", QVariant(neutron));
+
+	if (!r.hasXray()) {
+		mData.remove("xray scattering");
+		return;
+	}
+	partialFp.insert("value", QVariant(r.fp));
+	partialFpp.insert("value", QVariant(r.fpp));
 	xray.insert("f'", QVariant(partialFp));
 	xray.insert("f''", QVariant(partialFpp));
-	// calculate SLD
-	complex totalSLD = sldXray(totalElectrons, totalFp, totalFpp, totalVolume);
-	addComplex2Map(partialSLD, "value", totalSLD);
-	xray.insert("SLD cm^-2", QVariant(partialSLD));
+	addComplex2Map(sldXray, "value", r.sldXray);
+	xray.insert("SLD cm^-2", QVariant(sldXray));
 	set("xray scattering", QVariant(xray));
 }
 
+const CalcResult& 
+InputData::result() const
+{
+	return mResult;
+}
+
+void 
+InputData::initNeutronSweep(const CompiledCompound& cl,
+                            const CalcResult&       r,
+                            NeutronSweep&           sweep) const
+{
+	for(int i = 0; i < cl.size(); i++) {
+		const CompiledCompound::Entry& e = cl.at(i);
+		sweep.addElement(e.coefficient, 
+		                 e.element->nsCsIncoherent(),
+		                 e.element->nsCsTotal(),
+		                 e.element->nsCsAbsorption());
+	}
+	// molecules per cm^3
+	if (r.mass > 0.0) {
+		sweep.setNumberDensity(1e23 * avogadro() * r.density / r.mass);
+	}
+}
+
 void 
-InputData::calcData(const CompleteList& cl)
+InputData::calcNeutronCrossSections(const CompiledCompound& cl, 
+                                    CalcResult&             r) const
 {
-	QVariantMap partialElectrons;
-	calcElectrons(cl, partialElectrons);
+	r.absorption = r.incoherent = r.total = r.transmission = 0.0;
+	NeutronSweep sweep;
+	initNeutronSweep(cl, r, sweep);
+	double thickness = 0.1; // 1 mm
+	r.hasCrossSections = 
+		sweep.calculate(&r.neutronWavelength, 1, &thickness, 1);
+	if (!r.hasCrossSections) return;
+	r.absorption = sweep.absorption()[0];
+	r.incoherent = sweep.incoherent();
+	r.total = sweep.total()[0];
+	r.transmission = sweep.transmission()[0];
+}
 
-	double totalMass = 0.0;
-	double totalVolume = 0.0;
-	QVariantMap partialVolumes;
-	calcMassAndVolume(cl, partialVolumes, totalMass, totalVolume);
+bool 
+InputData::calcNeutronSweep(const CompiledCompound&    compound,
+                            const CalcResult&          r,
+                            const std::vector<double>& wavelengths,
+                            const std::vector<double>& thicknesses,
+                            const std::vector<double>& spectrum,
+                            NeutronSweep&              sweep) const
+{
+	if (compound.isEmpty()) return false;
+	if (!spectrum.empty() && spectrum.size() != wavelengths.size()) {
+		return false;
+	}
+	initNeutronSweep(compound, r, sweep);
+	if (wavelengths.empty()) return sweep.calculate(0, 0, 0, 0);
+	return sweep.calculate(&wavelengths[0], int(wavelengths.size()),
+	                       thicknesses.empty() ? 0 : &thicknesses[0],
+	                       int(thicknesses.size()),
+	                       spectrum.empty() ? 0 : &spectrum[0]);
+}
 
-	QVariantMap neutron;
-	calcNSL(cl, totalVolume, neutron, &Element::nslCoherent, "coherent scattering length 1e-15m", "SLD coherent 1/cm^2");
-	calcNSL(cl, totalVolume, neutron, &Element::nslIncoherent, "incoherent scattering length 1e-15m", "SLD incoherent 1/cm^2");
-	set("neutron scattering", QVariant(neutron));
+bool 
+InputData::calcDeuteration(double             exchangeable,
+                           double             deuterable,
+                           DeuterationSeries& series) const
+{
+	if (mCompound.isEmpty()) return false;
+	return initDeuteration(mCompound, mResult, 
+	                       exchangeable, deuterable, series);
+}
+
+bool 
+InputData::calcDeuteration(const QByteArray&  formula,
+                           double             exchangeable,
+                           double             deuterable,
+                           CalcResult&        r,
+                           DeuterationSeries& series)
+{
+	compile(formula, mRowCompound);
+	calcResult(mRowCompound, r);
+	return initDeuteration(mRowCompound, r, exchangeable, deuterable, series);
+}
 
-	calcXrayEnergies(cl, partialVolumes, partialElectrons);
+bool 
+InputData::initDeuteration(const CompiledCompound& cl,
+                           const CalcResult&       r,
+                           double                  exchangeable,
+                           double                  deuterable,
+                           DeuterationSeries&      series) const
+{
+	if (exchangeable < 0.0 || deuterable < 0.0 || r.volume <= 0.0) {
+		return false;
+	}
+	double hydrogens = 0.0;
+	for(int i = 0; i < cl.size(); i++) {
+		const CompiledCompound::Entry& e = cl.at(i);
+		if (e.element->symbol() == "H" && !e.element->isIsotope()) {
+			hydrogens += e.coefficient;
+		}
+	}
+	if (exchangeable + deuterable > hydrogens + 1e-9) return false;
+
+	cfp::CompoundElement deuterium;
+	deuterium.setSymbol("H");
+	deuterium.setNucleons(2);
+	Element::ConstPtr hp = mDB->getElement(ElementDatabase::KeyType("H"));
+	Element::ConstPtr dp = mDB->getElement(deuterium);
+	Element::ConstPtr op = mDB->getElement(ElementDatabase::KeyType("O"));
+	if (!hp || !dp || !op) return false;
+
+	// the volume is not changed by deuteration, see calcNSL()
+	complex perAtom = 1e8 * (dp->nslCoherent() - hp->nslCoherent()) / r.volume;
+	series.setCompound(r.sldCoherent, 
+	                   exchangeable * perAtom, deuterable * perAtom);
+	series.setSolvent(waterSld(hp, op, waterDensity()),
+	                  waterSld(dp, op, heavyWaterDensity()));
+	return true;
+}
+
+complex 
+InputData::waterSld(const Element * hydrogen, 
+                    const Element * oxygen, 
+                    double          density) const
+{
+	CompiledCompound::Entry h, o;
+	h.element = h.xrayElement = hydrogen;
+	h.id = hydrogen->id();
+	h.coefficient = 2.0;
+	o.element = o.xrayElement = oxygen;
+	o.id = oxygen->id();
+	o.coefficient = 1.0;
+	CompiledCompound cl;
+	cl.mEntries.push_back(h);
+	cl.mEntries.push_back(o);
+	CalcResult r;
+	r.density = density;
+	r.partials.resize(cl.size());
+	calcMassAndVolume(cl, r);
+	calcNSL(cl, r);
+	return r.sldCoherent;
+}
+
+bool 
+InputData::calcXraySweep(const CompiledCompound&    compound,
+                         const CalcResult&          r,
+                         const std::vector<double>& energies,
+                         XraySweep&                 sweep) const
+{
+	if (compound.isEmpty()) return false;
+	for(int i = 0; i < compound.size(); i++) 
+	{
+		const CompiledCompound::Entry& e = compound.at(i);
+		if (!e.xrayElement) return false;
+		sweep.addElement(e.xrayElement->xrayCoefficients(), 
+		                 e.coefficient);
+	}
+	sweep.setElectrons(r.electrons);
+	sweep.setVolume(1e-8 * r.volume);
+	if (energies.empty()) return sweep.calculate(0, 0);
+	return sweep.calculate(&energies[0], int(energies.size()));
 }
 
 std::ostream& 
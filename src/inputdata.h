@@ -26,9 +26,14 @@
 
 #include <iostream>
 #include <QVariant>
-#include <QValidator>
 #include <cfp/cfp.h>
 #include "elementdatabase.h"
+#include "xraysweep.h"
+#include "neutronsweep.h"
+#include "deuterationseries.h"
+#include "calcresult.h"
+#include "compiledcompound.h"
+#include "resultcache.h"
 
 
 class InputData;
@@ -44,9 +49,10 @@ namespace std {
  * Stores GUI input data and performs compound calculations. User input from 
  * the GUI is stored in hash tables with QVariant data type. It is parsed on 
  * request by interpretFormula() which gets detailed chemical element 
- * characteristics from the associated ElementDatabase, calculates all 
- * total and partial compound characteristics and stores the results in the 
- * hash table where it can be retrieved on request by get().
+ * characteristics from the associated ElementDatabase and calculates all 
+ * total and partial compound characteristics. They are available as typed
+ * CalcResult by result(). For display, they are also stored in the 
+ * hash table where they can be retrieved on request by get().
  *
  * Currently, the results are stored with the following keys in a hierarchical
  * structure by use of \e QVariantMap as a container for further \e QVariant types:
@@ -86,6 +92,10 @@ namespace std {
  *     - "SLD incoherent 1/cm^2"               QVariantMap
  *         - "value"                           total complex value: QVariant(complex)
  *         <one entry per element>             [chem. symbol, QVariant(complex)]
+ *     - "absorption cross section 1/cm"       at the given wavelength: QVariant(double)
+ *     - "incoherent cross section 1/cm"       QVariant(double)
+ *     - "total cross section 1/cm"            at the given wavelength: QVariant(double)
+ *     - "transmission of 1 mm"                at the given wavelength: QVariant(double)
  *
  * QVariant(complex) ==> QVariant( QVariantList( QVariant(double), QVariant(double) ))
  * \endcode
@@ -95,17 +105,31 @@ class InputData
 	/// Hash table type for internal data organization.
 	typedef QHash<QString, QVariant> QHashType;
 
-	/// Combined type for the chemical element signature from a formula and
-	/// the element dataset from the database.
-	typedef QPair<cfp::CompoundElement, Element::Ptr> ElemPair;
-
-	/// A List of combined element types. Can be interpreted as a compound 
-	/// (from formula parsing) extended by pointers to the according 
-	/// database elements.
-	typedef QList<ElemPair> CompleteList;
+	/// Stages of the calculation by calcResult(). Each one depends on 
+	/// the formula and on the input values noted, and on the stages 
+	/// before. calcData() repeats only the stages whose input values 
+	/// changed.
+	enum Stage {
+		/// Partial names and electrons, calcElectrons().
+		STAGE_COMPOSITION = 0x01,
+		/// Mass, volume, NSL and SLD, calcMassAndVolume() and calcNSL().
+		/// Depends on the density.
+		STAGE_VOLUME      = 0x02,
+		/// calcNeutronCrossSections(). Depends on the density and the 
+		/// neutron wavelength.
+		STAGE_NEUTRON     = 0x04,
+		/// X-Ray scattering factors, calcXrayEnergies(). Depends on the 
+		/// X-Ray energy. Without it, STAGE_VOLUME updates the X-Ray SLD 
+		/// only, see calcXraySld().
+		STAGE_XRAY        = 0x08,
+		/// All stages.
+		STAGE_ALL         = 0x0f
+	};
 public:
 	/// Constructor.
-	InputData(ElementDatabase& db);
+	/// \param[in] db Element database, it has to outlive this object.
+	///            Aliases are added to it by its owner.
+	InputData(const ElementDatabase& db);
 
 	/// Adds data.
 	/// \param[in] key Name of the entry.
@@ -128,18 +152,121 @@ public:
 	/// \returns Data associated to the specified key.
 	QVariant getInit(const QString& key) const;
 
-	/// Parses the given formula character string. Stores the resulting
-	/// compound in the database with the supplied formula as key.
-	/// \param[in] formulaKey The formula to interpret.
+	/// Parses the formula stored with the given key, if it or the
+	/// database changed since the last call, and calculates all
+	/// characteristics of the compound. Replaces the formula by its 
+	/// empirical formula. The database is not modified.
+	/// \param[in] formulaKey Key of the formula to interpret, see set().
 	void interpretFormula(const QString& formulaKey);
 
 	/// Returns the compound from recent formula parsing.
 	const cfp::Compound& empiricalFormula() const;
 
-	/// Adds a new alias to the element database of type 
-	/// ElementDatabase.
-	/// \param[in] name Alias name.
-	void addAlias(const QString& name);
+	/// Returns the typed results of recent formula parsing.
+	const CalcResult& result() const;
+
+	/// Parses the given formula and calculates all compound 
+	/// characteristics without storing anything here, 
+	/// result() remains unchanged. Throws cfp::Error on parse errors
+	/// and ErrorUnknownElement. Uses the formula parser of this object,
+	/// thus concurrent calculations require one InputData each.
+	/// \param[in] formula The formula to interpret.
+	/// \param[in,out] r Provides the input values density, X-Ray 
+	///                energy and neutron wavelength, receives all 
+	///                calculated values.
+	void calculate(const QByteArray& formula, CalcResult& r);
+
+	/// Parses the given formula, expands its aliases and looks up all
+	/// of its elements in the database. Throws cfp::Error on parse 
+	/// errors and ErrorUnknownElement, \e compound is unchanged then. 
+	/// Uses the formula parser of this object.
+	/// \param[in] formula The formula to interpret.
+	/// \param[out] compound Receives the compiled formula.
+	void compile(const QByteArray& formula, CompiledCompound& compound);
+
+	/// Calculates all characteristics of a compiled compound, like 
+	/// calculate() but without parsing anything. It may be called by
+	/// several threads at once.
+	/// \param[in] compound Compiled with the current database.
+	/// \param[in,out] r Provides the input values density, X-Ray 
+	///                energy and neutron wavelength, receives all 
+	///                calculated values.
+	void evaluate(const CompiledCompound& compound, CalcResult& r) const;
+
+	/// Sets a cache for the results of interpretFormula() and 
+	/// calculate(). Compounds calculated before with identical input 
+	/// values are taken from it instead of being calculated again.
+	/// \param[in] cache The cache to use, may be shared with other 
+	///            InputData objects. NULL disables caching (default).
+	void setResultCache(ResultCache * cache);
+
+	/// Calculates the X-Ray scattering factors and SLD of a compiled 
+	/// compound for many energies at once. It may be called by several
+	/// threads at once, like evaluate().
+	/// \param[in] compound Compiled with the current database.
+	/// \param[in] r Result of evaluate() for the compound, provides
+	///            the number of electrons and the volume.
+	/// \param[in] energies X-Ray energies in eV, sorted in increasing
+	///            order.
+	/// \param[out] sweep Receives the results for all energies.
+	/// \returns False, if the compound is empty, an element has no
+	///          X-Ray data, the volume is not positive or the energies
+	///          are not sorted.
+	bool calcXraySweep(const CompiledCompound&    compound,
+	                   const CalcResult&          r,
+	                   const std::vector<double>& energies,
+	                   XraySweep&                 sweep) const;
+
+	/// Calculates neutron cross sections and the transmission of a 
+	/// compiled compound for many wavelengths and sample thicknesses at
+	/// once, see NeutronSweep::calculate(). It may be called by several
+	/// threads at once, like evaluate().
+	/// \param[in] compound Compiled with the current database.
+	/// \param[in] r Result of evaluate() for the compound, provides
+	///            the mass and the density.
+	/// \param[in] wavelengths Neutron wavelengths in nm.
+	/// \param[in] thicknesses Sample thicknesses in cm.
+	/// \param[in] spectrum Weight of each wavelength, may be empty.
+	/// \param[out] sweep Receives the results for the whole grid.
+	/// \returns False, if the compound is empty or the input is invalid.
+	bool calcNeutronSweep(const CompiledCompound&    compound,
+	                      const CalcResult&          r,
+	                      const std::vector<double>& wavelengths,
+	                      const std::vector<double>& thicknesses,
+	                      const std::vector<double>& spectrum,
+	                      NeutronSweep&              sweep) const;
+
+	/// Prepares the contrast variation of the compound from recent 
+	/// formula parsing in \f$ H_2O \f$/\f$ D_2O \f$ mixtures, see
+	/// DeuterationSeries. Only natural hydrogen (H) of the formula is
+	/// replaced. The solvent SLDs are calculated for 25 \f$ ^\circ C \f$.
+	/// \param[in] exchangeable Number of exchangeable hydrogens per 
+	///            formula unit.
+	/// \param[in] deuterable Number of deuterable hydrogens per formula
+	///            unit.
+	/// \param[out] series Receives the coefficients of the compound and
+	///             the solvent.
+	/// \returns False, if there is no compound, it contains less 
+	///          hydrogen or hydrogen, deuterium or oxygen are missing in
+	///          the database.
+	bool calcDeuteration(double             exchangeable,
+	                     double             deuterable,
+	                     DeuterationSeries& series) const;
+
+	/// Parses the given formula and prepares the contrast variation of
+	/// the compound, like calculate() and the method above.
+	/// \param[in] formula The formula to interpret.
+	/// \param[in] exchangeable Number of exchangeable hydrogens.
+	/// \param[in] deuterable Number of deuterable hydrogens.
+	/// \param[in,out] r Provides the input values, receives all 
+	///                calculated values of the compound as given.
+	/// \param[out] series Receives the coefficients.
+	/// \returns False, if the compound is not suitable, see above.
+	bool calcDeuteration(const QByteArray&  formula,
+	                     double             exchangeable,
+	                     double             deuterable,
+	                     CalcResult&        r,
+	                     DeuterationSeries& series);
 
 	friend std::ostream& std::operator<<(std::ostream& o, const InputData& ind);
 private:
@@ -157,88 +284,159 @@ private:
 
 	/// Adds references to database elements to a given compound (from
 	/// parsing). For every element in the compound \e comp it queries 
-	/// the element database and adds a reference to it in \e list.
-	/// If not found, throws ErrorUnknownElement.
-	/// \param[out] list List of chemical element signatures combined with
-	///             element database references.
+	/// the element database and adds a reference to it in \e list,
+	/// aliases are expanded. If not found, throws ErrorUnknownElement.
+	/// \param[out] list Elements of a compiled compound.
 	/// \param[in] comp A list of chemical element signatures from parsing
 	///            a formula.
-	void buildCompleteList(CompleteList& list, const cfp::Compound& comp);
+	void buildEntryList(CompiledCompound::EntryList& list, 
+	                    const cfp::Compound&         comp) const;
+
+	/// Calculates all compound characteristics for a given formula.
+	/// \param[in] cl The compiled formula.
+	/// \param[in,out] r Provides the input values, receives all 
+	///                calculated values.
+	/// \param[in] stages The Stage values to calculate, \e r has to 
+	///            contain valid results of all others for \e cl.
+	void calcResult(const CompiledCompound& cl, CalcResult& r,
+	                int stages = STAGE_ALL) const;
 
 	/// Calculates all information which shall be displayed in the 
-	/// main window for a given formula.
-	/// \param[in] cl The completely defined formula.
-	void calcData(const CompleteList& cl);
+	/// main window for a given formula, with the input values of the
+	/// form. Fills the result() and converts it by storeResult().
+	/// If the formula is the same as before, only the stages depending
+	/// on changed input values are calculated again.
+	/// \param[in] cl The compiled formula.
+	void calcData(const CompiledCompound& cl);
+
+	/// Takes the result from the result cache or calculates it by 
+	/// calcResult() and adds it to the cache.
+	/// \param[in] cl The compiled formula.
+	/// \param[in,out] r Provides the input values, receives all 
+	///                calculated values.
+	/// \param[in] stages Stages to calculate if it is not cached, see
+	///            calcResult().
+	void calcCached(const CompiledCompound& cl, 
+	                CalcResult&             r,
+	                int                     stages = STAGE_ALL) const;
+
+	/// Stores a result in the hash table with the keys described 
+	/// above, to be retrieved by get() for display.
+	/// \param[in] r The result to store.
+	void storeResult(const CalcResult& r);
 
 	/// Calculates total and partial number of electrons.
 	/// \param[in] cl Complete formula.
-	/// \param[out] partialElectrons Map with the number of electrons for
-	///             each chemical element (its symbol) in the formula.
-	double calcElectrons(const CompleteList& cl, 
-	                     QVariantMap&        partialElectrons);
+	/// \param[in,out] r Result with one partial entry per element of 
+	///                \e cl.
+	void calcElectrons(const CompiledCompound& cl, CalcResult& r) const;
+
+	/// Calculates total and partial mass and volume. Requires the 
+	/// density of \e r.
+	/// \param[in] cl Complete formula.
+	/// \param[in,out] r Result with one partial entry per element of 
+	///                \e cl.
+	void calcMassAndVolume(const CompiledCompound& cl, CalcResult& r) const;
+
+	/// Calculates total and partial neutron scattering lengths and 
+	/// densities, coherent and incoherent. Requires the volume of \e r.
+	/// \param[in] cl Complete formula.
+	/// \param[in,out] r Result with one partial entry per element of 
+	///                \e cl.
+	void calcNSL(const CompiledCompound& cl, CalcResult& r) const;
 
-	/// Calculates total and partial mass and volume.
+	/// Prepares the calculation of neutron cross sections.
 	/// \param[in] cl Complete formula.
-	/// \param[out] partialVolume Map with the volume fraction for each
-	///             chemical element (its symbol) in the formula.
-	/// \param[out] totalMass Total mass of the compound.
-	/// \param[out] totalVolume Total Volume of the compound.
-	void calcMassAndVolume(const CompleteList& cl, 
-	                       QVariantMap&        partialVolume,
-	                       double&             totalMass,
-	                       double&             totalVolume);
-
-	/// Calculates total and partial neutron scattering lengths and densities.
+	/// \param[in] r Result with the mass and density of the compound.
+	/// \param[out] sweep Receives the cross sections of all elements
+	///             and the number density of the compound.
+	void initNeutronSweep(const CompiledCompound& cl,
+	                      const CalcResult&   r,
+	                      NeutronSweep&       sweep) const;
+
+	/// Helper of calcDeuteration().
 	/// \param[in] cl Complete formula.
-	/// \param[in] totalVolume The total volume of the compound.
-	/// \param[in,out] neutron A Map which contains all neutron scattering
-	///                related data finally.
-	/// \param[in] func Member function of Element to retrieve the 
-	///            neutron scattering length (coherent or incoherent).
-	/// \param[in] slText Key for storing the total neutron scattering length.
-	/// \param[in] sldText Key for storing the partial neutron scattering densities.
-	void calcNSL(const CompleteList& cl, 
-		     double              totalVolume,
-	             QVariantMap&        neutron,
-	             complex (Element::*func)(void) const,
-	             const char        * slText,
-                     const char        * sldText);
+	/// \param[in] r Result with the volume and SLD of the compound.
+	/// \param[in] exchangeable Number of exchangeable hydrogens.
+	/// \param[in] deuterable Number of deuterable hydrogens.
+	/// \param[out] series Receives the coefficients.
+	bool initDeuteration(const CompiledCompound& cl,
+	                     const CalcResult&   r,
+	                     double              exchangeable,
+	                     double              deuterable,
+	                     DeuterationSeries&  series) const;
+
+	/// Calculates the coherent neutron SLD of water.
+	/// \param[in] hydrogen The hydrogen isotope of the water.
+	/// \param[in] oxygen Oxygen.
+	/// \param[in] density Density of the water in \f$ g/cm^3 \f$.
+	complex waterSld(const Element * hydrogen, 
+	                 const Element * oxygen, 
+	                 double          density) const;
+
+	/// Calculates macroscopic neutron cross sections and the 
+	/// transmission of 1 mm of the compound at the neutron wavelength
+	/// of \e r. Requires its mass.
+	/// \param[in] cl Complete formula.
+	/// \param[in,out] r Result with one partial entry per element of 
+	///                \e cl.
+	void calcNeutronCrossSections(const CompiledCompound& cl, 
+	                              CalcResult&         r) const;
 
 	/// Calculates total and partial X-Ray scattering coefficients as well
-	/// as total and partial X-Ray scattering length densities.
+	/// as total and partial X-Ray scattering length densities at the 
+	/// X-Ray energy of \e r. Requires its volumes and electrons.
 	/// \param[in] cl Complete formula.
-	/// \param[in] partialVolumes Partial volume fractions of the compound.
-	/// \param[in] partialElectrons Partial number of electrons of the 
-	///            compound.
-	void calcXrayEnergies(const CompleteList& cl,
-	                      const QVariantMap&  partialVolumes,
-	                      const QVariantMap&  partialElectrons);
+	/// \param[in,out] r Result with one partial entry per element of 
+	///                \e cl.
+	void calcXrayEnergies(const CompiledCompound& cl, CalcResult& r) const;
+
+	/// Calculates total and partial X-Ray scattering length densities 
+	/// from the scattering coefficients of \e r. Requires its volumes 
+	/// and electrons.
+	/// \param[in,out] r Result with the X-Ray scattering coefficients of
+	///                calcXrayEnergies().
+	void calcXraySld(CalcResult& r) const;
 
 	/// Helper of calcXrayEnergies()
 	/// \param[out] fp Xray scattering coefficient (first derivation)
 	/// \param[out] fpp Xray scattering coefficient (second derivation)
-	/// \param[in] ep Pointer to an element in a CompleteList
+	/// \param[in] e An element of a CompiledCompound
 	///            (to calculate the coefficients for).
 	/// \param[in] coeff Coefficient/weight of this Element from chemical
 	///		formula.
 	/// \param[in] energy User specified Xray energy.
-	/// \returns True, on success. False, if the given energy value is out
-	///          of range.
-	bool calcXrayCoefficients(double&           fp, 
-	                          double&           fpp,
-	                          Element::Ptr ep,
-	                          double            coeff,
-	                          double            energy);
+	/// \returns See XraySpan::interpolate(). BELOW_RANGE or ABOVE_RANGE,
+	///          if the given energy value is out of range.
+	XraySpan::Status calcXrayCoefficients(double&        fp, 
+	                                      double&        fpp,
+	                                      const Element& e,
+	                                      double         coeff,
+	                                      double         energy) const;
 
 private:
-	/// A reference to the element database.
-	ElementDatabase::Ptr mDB;
+	/// The element database, it is read only.
+	const ElementDatabase * mDB;
 	/// Initial input data (used for reset).
 	QHashType                 mInitData;
 	/// Input data and intermediate calculation results (buffer).
 	QHashType                 mData;
 	/// Chemical formula parser.
 	cfp::Parser               mFormulaParser;
+	/// Compound from recent formula parsing, see interpretFormula().
+	CompiledCompound          mCompound;
+	/// Formula text of mCompound, see interpretFormula().
+	QByteArray                mCompoundText;
+	/// Compound of recent calculate() calls, reused for its storage.
+	CompiledCompound          mRowCompound;
+	/// Results of recent formula parsing, see calcData().
+	CalcResult                mResult;
+	/// Optional cache of results, see setResultCache().
+	ResultCache *             mCache;
+	/// Empirical formula of mResult, see calcData().
+	std::string               mResultFormula;
+	/// Database revision of mResult, see calcData().
+	int                       mResultRevision;
 };
 
 /// The element entered by the user is not found in the database.
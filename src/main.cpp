@@ -25,12 +25,21 @@
 #include <cfp/cfp.h>
 #include "mainwindow.h"
 #include "elementdatabase.h"
+#include "staticelementtable.h"
 
 int main(int argc, char *argv[])
 {
-	// loading data from embedded ressource file system
 	ElementDatabase db;
-	db.addFromDirectory(":/data");
+#ifdef STATIC_ELEMENT_TABLE
+	// element data compiled into the program
+	db.addFromStaticTable(staticElementRecords, staticElementRecordCount);
+#else
+	// loading data from embedded ressource file system,
+	// prefer the compiled image, fall back to the XML files
+	if (!db.addFromBinary(":/elements.bin")) {
+		db.addFromDirectory(":/data");
+	}
+#endif
 
 	// create, show and execute the main window
 	QApplication app(argc, argv);
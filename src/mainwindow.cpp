@@ -41,6 +41,7 @@ MainWindow::MainWindow(QApplication &app, ElementDatabase& db)
 	  mDB(&db),
 	  mDataVisualizer(this, db)
 {
+	mInputData.setResultCache(&mResultCache);
 	mApp->installTranslator(&mTranslator);
 #ifdef DEBUG
 	if ( ! mLangPath.exists() ) 
@@ -322,7 +323,7 @@ void MainWindow::addAlias()
 	AliasNameDialog askForAlias(this);
 	int result = askForAlias.exec();
 	if (result == QDialog::Accepted) {
-		mInputData.addAlias(askForAlias.name());
+		mDB->addAlias(askForAlias.name(), mInputData.empiricalFormula());
 	}
 }
 
@@ -599,8 +600,8 @@ QString MainWindow::toString(const Element::PropertyVariant& var) const
 void MainWindow::showElementData(const QString& key)
 {
 	clearResultTable();
-	Element::Ptr ep = mDB->getElement(key);
-	if (ep.isNull()) {
+	Element::ConstPtr ep = mDB->getElement(key);
+	if (!ep) {
 		cfp::Compound comp = mDB->getAlias(key);
 		if (comp.size() > 0) {
 			ntrFormula->setEditText(QString::fromStdString(cfp::toString(comp)));
@@ -617,7 +618,6 @@ void MainWindow::showElementData(const QString& key)
 	QStandardItem * root = mModel.invisibleRootItem();
 	QStandardItem * item = root;
 	QStringFromBoostVariant qstringFromBoostVariant(this);
-	Element::PropertyValueIteratorConst it = ep->beginConst();
 	int propCount = Element::propertyCount() - 1;
 	for(int i=0; i < propCount; i++)
 	{
@@ -641,8 +641,8 @@ void MainWindow::showElementData(const QString& key)
 	if (ep->isIsotope()) { 
 		// has no xray-scattering data, 
 		// use that of the natural element (without nucleon number)
-		ep = mDB->getElement(ElementDatabase::KeyType(ep->symbol().c_str()));
-		if (ep.isNull()) 
+		const Element * natural = ep->xrayElement();
+		if (!natural) 
 		{
 #ifdef DEBUG
 			std::cerr << "MainWindow::showElementData: '"
@@ -651,23 +651,22 @@ void MainWindow::showElementData(const QString& key)
 #endif
 			return;
 		}
+		ep = natural;
 	}
 	QStringList headerLabels;
 	headerLabels << tr("Characteristic") << tr("Value");
-	if (!ep->xrayCoefficients().empty())
+	XraySpan xray = ep->xrayCoefficients();
+	if (!xray.empty())
 	{
 		item = new QStandardItem(tr("xray scattering"));
 		root->appendRow(item);
 		addModelEntry(item, tr("anomalous scattering coefficients"));
 		addModelEntry(item, tr("energy"), tr("fp"), tr("fpp"));
-		MapTriple::const_iterator it = ep->xrayCoefficients().begin();
-		MapTriple::const_iterator end = ep->xrayCoefficients().end();
-		while(it != end) {
+		for(int i=0; i < xray.size(); i++) {
 			addModelEntry(item, 
-				qstringFromDouble(it->first), 
-				qstringFromDouble(it->second.first), 
-				qstringFromDouble(it->second.second));
-			it++;
+				qstringFromDouble(xray.energy(i)), 
+				qstringFromDouble(xray.fp(i)), 
+				qstringFromDouble(xray.fpp(i)));
 		}
 		headerLabels << tr("Value");
 	}
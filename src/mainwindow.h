@@ -131,6 +131,8 @@ typedef QList<QAction *> LangActionList;
  * several compounds at different mass or volume, and the SLD calc could
  * deduce the mass, volume and molar fraction, and finally the transmission
  * and incoherent background as a function of the thickness and wavelength.
+ * The calculation is available as Mixture (qsldcalc-cli --mixture), the
+ * GUI is missing.
  */
 class MainWindow: public QMainWindow, private Ui::MainWindow
 {
@@ -316,6 +318,10 @@ private:
 	QString	                  mAboutTitle;
 	QString                   mAboutText;
 
+	/// Results of recent calculations, repeated input is not 
+	/// calculated again.
+	ResultCache               mResultCache;
+
 	/// Stores input data and calculates compound characteristics.
 	InputData                 mInputData;
 
@@ -0,0 +1,170 @@
+/*
+ * src/mixture.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include "utils.h"
+#include "mixture.h"
+
+/// \f$ \pi \f$, M_PI is not available everywhere.
+static const double PI = 3.14159265358979323846;
+
+Mixture::Mixture()
+{
+	clear();
+}
+
+void 
+Mixture::clear()
+{
+	mComponents.clear();
+	mMassFraction.clear();
+	mVolumeFraction.clear();
+	mMoleFraction.clear();
+	mDensity = 0.0;
+	mSldCoherent = mSldIncoherent = mSldXray = complex(0.0, 0.0);
+	mHasXray = mHasCrossSections = false;
+	mScattering = mIncoherent = mAbsorption = 0.0;
+}
+
+int 
+Mixture::addComponent(const CalcResult& r)
+{
+	Component c;
+	c.density = r.density;
+	c.molarMass = r.mass;
+	c.sldCoherent = r.sldCoherent;
+	c.sldIncoherent = r.sldIncoherent;
+	c.hasXray = r.hasXray();
+	c.sldXray = r.sldXray;
+	// absorption scales linearly with the wavelength, see NeutronSweep
+	c.hasCrossSections = r.hasCrossSections && r.neutronWavelength > 0.0;
+	c.scattering = r.total - r.absorption;
+	c.incoherent = r.incoherent;
+	c.absorption = (c.hasCrossSections ? r.absorption * 
+	                neutronReferenceWavelength() / r.neutronWavelength : 0.0);
+	c.mass = 0.0;
+	mComponents.push_back(c);
+	return size() - 1;
+}
+
+bool 
+Mixture::setAmount(int index, double amount, Unit unit)
+{
+	if (index < 0 || index >= size() || !(amount >= 0.0)) return false;
+	Component& c = mComponents[index];
+	double factor = 1.0;
+	switch (unit) {
+		case MASS:   factor = 1.0; break;
+		case VOLUME: factor = c.density; break;
+		case MOLES:  factor = c.molarMass; break;
+	}
+	if (!(factor > 0.0)) return false;
+	c.mass = amount * factor;
+	return true;
+}
+
+bool 
+Mixture::calculate()
+{
+	int n = size();
+	mMassFraction.assign(n, 0.0);
+	mVolumeFraction.assign(n, 0.0);
+	mMoleFraction.assign(n, 0.0);
+	mDensity = 0.0;
+	mSldCoherent = mSldIncoherent = mSldXray = complex(0.0, 0.0);
+	mHasXray = mHasCrossSections = false;
+	mScattering = mIncoherent = mAbsorption = 0.0;
+
+	double mass = 0.0, volume = 0.0, moles = 0.0;
+	for (int i = 0; i < n; i++) {
+		const Component& c = mComponents[i];
+		if (c.mass <= 0.0) continue;
+		// it would count to the mass but not to the volume
+		if (!(c.density > 0.0 && c.molarMass > 0.0)) return false;
+		mass += c.mass;
+		volume += c.mass / c.density;
+		moles += c.mass / c.molarMass;
+	}
+	if (mass <= 0.0) return false;
+
+	mHasXray = mHasCrossSections = true;
+	for (int i = 0; i < n; i++) 
+	{
+		const Component& c = mComponents[i];
+		if (c.mass <= 0.0) continue;
+		mMassFraction[i] = c.mass / mass;
+		mVolumeFraction[i] = c.mass / c.density / volume;
+		mMoleFraction[i] = c.mass / c.molarMass / moles;
+		double phi = mVolumeFraction[i];
+		mSldCoherent += phi * c.sldCoherent;
+		mSldIncoherent += phi * c.sldIncoherent;
+		mSldXray += phi * c.sldXray;
+		mHasXray = mHasXray && c.hasXray;
+		mHasCrossSections = mHasCrossSections && c.hasCrossSections;
+		mScattering += phi * c.scattering;
+		mIncoherent += phi * c.incoherent;
+		mAbsorption += phi * c.absorption;
+	}
+	mDensity = mass / volume;
+	return true;
+}
+
+double 
+Mixture::massFraction(int index) const
+{
+	if (index < 0 || index >= int(mMassFraction.size())) return 0.0;
+	return mMassFraction[index];
+}
+
+double 
+Mixture::volumeFraction(int index) const
+{
+	if (index < 0 || index >= int(mVolumeFraction.size())) return 0.0;
+	return mVolumeFraction[index];
+}
+
+double 
+Mixture::moleFraction(int index) const
+{
+	if (index < 0 || index >= int(mMoleFraction.size())) return 0.0;
+	return mMoleFraction[index];
+}
+
+double 
+Mixture::incoherentBackground() const
+{
+	return mIncoherent / (4.0 * PI);
+}
+
+double 
+Mixture::total(double wavelength) const
+{
+	return mScattering + 
+	       mAbsorption * wavelength / neutronReferenceWavelength();
+}
+
+double 
+Mixture::transmission(double wavelength, double thickness) const
+{
+	return exp(-total(wavelength) * thickness);
+}
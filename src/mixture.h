@@ -0,0 +1,164 @@
+/*
+ * src/mixture.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EDB_MIXTURE_H
+#define EDB_MIXTURE_H
+
+#include <vector>
+#include "calcresult.h"
+
+/**
+ * Combines several compounds to a mixture, each at a given mass, volume
+ * or amount of substance. It derives the mass, volume and mole fractions
+ * of the components and the scattering properties of the mixture.
+ *
+ * Each component is described by the totals of its CalcResult, which 
+ * InputData::calculate() computes once from the elements of its formula.
+ * Changing an amount does not parse or visit any element again, 
+ * calculate() takes a single pass over the components. 
+ *
+ * The volumes of the components are assumed to be additive (ideal 
+ * mixing). Therefore the SLDs and macroscopic cross sections of the 
+ * mixture are the averages of those of the components, weighted by 
+ * their volume fractions \f$ \phi_i \f$:
+ * \f[ \rho = \sum_i \phi_i \rho_i, \qquad \Sigma = \sum_i \phi_i \Sigma_i \f]
+ */
+class Mixture
+{
+public:
+	/// Unit of the amount of a component.
+	typedef enum {
+		MASS,   //!< Mass in g.
+		VOLUME, //!< Volume in \f$ cm^3 \f$.
+		MOLES   //!< Amount of substance in mol.
+	} Unit;
+
+	/// Creates an empty mixture.
+	Mixture();
+
+	/// Adds a component with an amount of zero.
+	/// \param[in] r Calculated compound, its density is the density of
+	///            the pure component. Its neutron cross sections are
+	///            used if available at a wavelength above zero, its 
+	///            X-Ray SLD if available.
+	/// \returns Index of the new component.
+	int addComponent(const CalcResult& r);
+
+	/// Removes all components.
+	void clear();
+
+	/// Returns the number of components.
+	int size() const { return int(mComponents.size()); }
+
+	/// Sets the amount of a component. 
+	/// \param[in] index Index of the component, see addComponent().
+	/// \param[in] amount Amount of the component, not negative.
+	/// \param[in] unit Unit of \e amount.
+	/// \returns False if the amount is invalid or if it can not be 
+	///          converted to a mass, i.e. a volume of a component without
+	///          density or moles of one without molar mass. The amount 
+	///          is not changed then.
+	bool setAmount(int index, double amount, Unit unit = MASS);
+
+	/// Calculates all fractions and properties of the mixture from the 
+	/// current amounts.
+	/// \returns False, if the mixture is empty, all amounts are zero or
+	///          a component with an amount has no density or no molar 
+	///          mass. Its volume or moles would be unknown.
+	bool calculate();
+
+	/// Mass fraction of a component.
+	double massFraction(int index) const;
+	/// Volume fraction of a component.
+	double volumeFraction(int index) const;
+	/// Mole fraction of a component.
+	double moleFraction(int index) const;
+
+	/// Density of the mixture in \f$ g/cm^3 \f$.
+	double density() const { return mDensity; }
+
+	/// Coherent neutron SLD in \f$ cm^{-2} \f$.
+	const complex& sldCoherent() const { return mSldCoherent; }
+	/// Incoherent neutron SLD in \f$ cm^{-2} \f$.
+	const complex& sldIncoherent() const { return mSldIncoherent; }
+
+	/// Tests if the X-Ray SLD is valid, i.e. known for all components.
+	bool hasXray() const { return mHasXray; }
+	/// X-Ray SLD in \f$ cm^{-2} \f$.
+	const complex& sldXray() const { return mSldXray; }
+
+	/// Tests if the neutron cross sections are known for all components.
+	bool hasCrossSections() const { return mHasCrossSections; }
+
+	/// Macroscopic incoherent scattering cross section in 1/cm.
+	double incoherent() const { return mIncoherent; }
+
+	/// Incoherent background, the isotropic differential scattering 
+	/// cross section \f$ \Sigma_{inc} / 4\pi \f$ in \f$ 1/(cm\,sr) \f$.
+	double incoherentBackground() const;
+
+	/// Macroscopic total cross section of scattering and absorption in
+	/// 1/cm.
+	/// \param[in] wavelength Neutron wavelength in nm.
+	double total(double wavelength) const;
+
+	/// Transmission of a sample of the mixture.
+	/// \param[in] wavelength Neutron wavelength in nm.
+	/// \param[in] thickness Sample thickness in cm.
+	double transmission(double wavelength, double thickness) const;
+private:
+	/// Totals of a single component.
+	struct Component
+	{
+		double  density;       //!< In \f$ g/cm^3 \f$.
+		double  molarMass;     //!< In g/mol.
+		complex sldCoherent;   //!< Coherent neutron SLD.
+		complex sldIncoherent; //!< Incoherent neutron SLD.
+		bool    hasXray;       //!< The X-Ray SLD is valid.
+		complex sldXray;       //!< X-Ray SLD.
+		/// The neutron cross sections are valid.
+		bool    hasCrossSections;
+		double  scattering;    //!< Macroscopic scattering cross section.
+		double  incoherent;    //!< Macroscopic incoherent cross section.
+		/// Macroscopic absorption cross section at 
+		/// neutronReferenceWavelength().
+		double  absorption;
+		double  mass;          //!< Current amount in g.
+	};
+
+	std::vector<Component> mComponents; //!< All components.
+	std::vector<double>    mMassFraction;   //!< See massFraction().
+	std::vector<double>    mVolumeFraction; //!< See volumeFraction().
+	std::vector<double>    mMoleFraction;   //!< See moleFraction().
+	double  mDensity;          //!< See density().
+	complex mSldCoherent;      //!< See sldCoherent().
+	complex mSldIncoherent;    //!< See sldIncoherent().
+	bool    mHasXray;          //!< See hasXray().
+	complex mSldXray;          //!< See sldXray().
+	bool    mHasCrossSections; //!< See hasCrossSections().
+	double  mScattering;       //!< Macroscopic scattering cross section.
+	double  mIncoherent;       //!< See incoherent().
+	double  mAbsorption;       //!< At neutronReferenceWavelength().
+};
+
+#endif
@@ -0,0 +1,423 @@
+/*
+ * src/ndjsonserver.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin, 
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cctype>
+#include <cfloat>
+#include <climits>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include "resultformat.h"
+#include "ndjsonserver.h"
+
+namespace {
+
+/// Reads the values of a flat JSON object.
+class JsonReader
+{
+public:
+	explicit JsonReader(const std::string& text)
+		: mText(text), mPos(0)
+	{}
+
+	/// Reads the next key of the object, expects '{' first.
+	/// \returns False at the end of the object or on error.
+	bool nextKey(std::string& key);
+
+	/// Reads a value and stores its JSON text.
+	bool value(std::string& text);
+	/// Reads a string value.
+	bool string(std::string& str);
+	/// Reads a number value, strictly as defined by JSON. NaN, 
+	/// infinity, hexadecimal numbers and values out of the range of
+	/// double are rejected.
+	bool number(double& value);
+
+	/// Tests if all of the text was read without error.
+	bool atEnd() { skipSpace(); return mPos == mText.size(); }
+	/// Describes the first error.
+	const std::string& error() const { return mError; }
+private:
+	void skipSpace();
+	bool expect(char c);
+	bool fail(const char * msg);
+	/// Skips decimal digits. \returns Their count.
+	size_t skipDigits();
+
+	const std::string& mText;
+	size_t             mPos;
+	std::string        mError;
+};
+
+void 
+JsonReader::skipSpace()
+{
+	while (mPos < mText.size() && 
+	       (mText[mPos] == ' ' || mText[mPos] == '\t' || 
+	        mText[mPos] == '\r' || mText[mPos] == '\n')) 
+	{
+		mPos++;
+	}
+}
+
+bool 
+JsonReader::fail(const char * msg)
+{
+	if (mError.empty()) mError = msg;
+	return false;
+}
+
+size_t 
+JsonReader::skipDigits()
+{
+	size_t begin = mPos;
+	while (mPos < mText.size() && isdigit(mText[mPos])) mPos++;
+	return mPos - begin;
+}
+
+bool 
+JsonReader::expect(char c)
+{
+	skipSpace();
+	if (mPos < mText.size() && mText[mPos] == c) {
+		mPos++;
+		return true;
+	}
+	return false;
+}
+
+bool 
+JsonReader::nextKey(std::string& key)
+{
+	if (mPos == 0) {
+		if (!expect('{')) return fail("object expected");
+		if (expect('}')) return false;
+	} else {
+		if (expect('}')) return false;
+		if (!expect(',')) return fail("',' expected");
+	}
+	if (!string(key)) return false;
+	if (!expect(':')) return fail("':' expected");
+	return true;
+}
+
+bool 
+JsonReader::string(std::string& str)
+{
+	str.clear();
+	if (!expect('"')) return fail("string expected");
+	while (mPos < mText.size()) 
+	{
+		char c = mText[mPos++];
+		if (c == '"') return true;
+		if (c != '\\') {
+			str += c;
+			continue;
+		}
+		if (mPos >= mText.size()) break;
+		c = mText[mPos++];
+		switch (c) {
+			case 'b': str += '\b'; break;
+			case 'f': str += '\f'; break;
+			case 'n': str += '\n'; break;
+			case 'r': str += '\r'; break;
+			case 't': str += '\t'; break;
+			case 'u': {
+				// formulas are ASCII, other characters are replaced
+				if (mPos + 4 > mText.size()) return fail("invalid escape");
+				long code = strtol(mText.substr(mPos, 4).c_str(), 0, 16);
+				str += (code > 0 && code < 0x80 ? char(code) : '?');
+				mPos += 4;
+				break;
+			}
+			default: str += c; break;
+		}
+	}
+	return fail("unterminated string");
+}
+
+bool 
+JsonReader::number(double& value)
+{
+	skipSpace();
+	// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+	size_t begin = mPos;
+	if (mPos < mText.size() && mText[mPos] == '-') mPos++;
+	if (mPos < mText.size() && mText[mPos] == '0') {
+		mPos++;
+	} else if (skipDigits() == 0) {
+		mPos = begin;
+		return fail("number expected");
+	}
+	if (mPos < mText.size() && mText[mPos] == '.') {
+		mPos++;
+		if (skipDigits() == 0) return fail("invalid number");
+	}
+	if (mPos < mText.size() && (mText[mPos] == 'e' || mText[mPos] == 'E')) {
+		mPos++;
+		if (mPos < mText.size() && 
+		    (mText[mPos] == '+' || mText[mPos] == '-')) 
+		{
+			mPos++;
+		}
+		if (skipDigits() == 0) return fail("invalid number");
+	}
+	value = strtod(mText.substr(begin, mPos - begin).c_str(), 0);
+	if (value > DBL_MAX || value < -DBL_MAX) {
+		return fail("number out of range");
+	}
+	return true;
+}
+
+bool 
+JsonReader::value(std::string& text)
+{
+	skipSpace();
+	size_t begin = mPos;
+	if (mPos < mText.size() && mText[mPos] == '"') {
+		std::string str;
+		if (!string(str)) return false;
+	} else if (mText.compare(mPos, 4, "true") == 0 || 
+	           mText.compare(mPos, 4, "null") == 0) {
+		mPos += 4;
+	} else if (mText.compare(mPos, 5, "false") == 0) {
+		mPos += 5;
+	} else if (mPos < mText.size() && 
+	           (mText[mPos] == '-' || isdigit(mText[mPos]))) {
+		double d;
+		if (!number(d)) return false;
+	} else {
+		return fail("scalar value expected");
+	}
+	text = mText.substr(begin, mPos - begin);
+	return true;
+}
+
+/// Parses a request line.
+/// \returns False, if it is malformed.
+bool 
+parseRequest(const std::string& line, BatchInput& in, 
+             std::string& id, std::string& error)
+{
+	JsonReader json(line);
+	std::string key, formula, raw;
+	bool hasFormula = false;
+	bool ok = true;
+	while (ok && json.nextKey(key)) 
+	{
+		if (key == "formula") {
+			ok = json.string(formula);
+			hasFormula = true;
+		} else if (key == "density") {
+			ok = json.number(in.density);
+		} else if (key == "energy") {
+			ok = json.number(in.xrayEnergy);
+		} else if (key == "wavelength") {
+			ok = json.number(in.neutronWavelength);
+		} else if (key == "id") {
+			ok = json.value(id);
+		} else {
+			ok = json.value(raw); // ignored
+		}
+	}
+	in.formula = QByteArray(formula.data(), int(formula.size()));
+	in.xrayEnergy *= 1000.0; // keV -> eV
+	if (!json.error().empty() || !json.atEnd()) {
+		error = "invalid JSON: " + 
+			(json.error().empty() ? std::string("trailing characters") 
+			                      : json.error());
+		return false;
+	}
+	if (!hasFormula) {
+		error = "no formula";
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+/// A request in progress.
+class NdjsonServer::Slot
+{
+public:
+	Slot(): valid(false), end(false) {}
+
+	BatchInput  in;    //!< Parsed request.
+	std::string id;    //!< JSON text of the request id.
+	bool        valid; //!< The request could be parsed.
+	bool        end;   //!< Marks the end of the input.
+	BatchResult out;   //!< Result.
+	QSemaphore  done;  //!< Released when the result is available.
+};
+
+/// Calculates requests in the order of their arrival.
+class NdjsonServer::Worker: public QRunnable
+{
+public:
+	Worker(const ElementDatabase& db, std::vector<Slot*>& ring, 
+	       QSemaphore& queued, QAtomicInt& next, QAtomicInt& total,
+	       ResultCache * cache)
+		: mCalculator(db), mSlots(ring), 
+		  mQueued(queued), mNext(next), mTotal(total)
+	{
+		mCalculator.setResultCache(cache);
+	}
+
+	void run()
+	{
+		for (;;) 
+		{
+			mQueued.acquire();
+			int seq = mNext.fetchAndAddOrdered(1);
+			if (seq >= int(mTotal)) break;
+			Slot& s = *mSlots[seq % mSlots.size()];
+			if (s.valid) mCalculator.calculate(s.in, s.out);
+			s.done.release();
+		}
+	}
+private:
+	RowCalculator       mCalculator;
+	std::vector<Slot*>& mSlots;
+	QSemaphore&         mQueued; //!< Number of requests to calculate.
+	QAtomicInt&         mNext;   //!< Sequence number of the next one.
+	QAtomicInt&         mTotal;  //!< Number of requests, once known.
+};
+
+/// Writes results in the order of the requests.
+class NdjsonServer::Writer: public QRunnable
+{
+public:
+	Writer(std::vector<Slot*>& ring, QSemaphore& free, FILE * out)
+		: mFailed(0), mSlots(ring), mFree(free), mOut(out)
+	{}
+
+	void run()
+	{
+		for (int seq = 0;; seq++) 
+		{
+			Slot& s = *mSlots[seq % mSlots.size()];
+			if (!s.done.tryAcquire()) {
+				fflush(mOut);
+				s.done.acquire();
+			}
+			if (s.end) break;
+			printResult(mOut, s.in, s.out, true, s.id);
+			if (s.out.status != BatchResult::OK) mFailed++;
+			mFree.release();
+		}
+		fflush(mOut);
+	}
+
+	int mFailed; //!< Number of requests which did not succeed.
+private:
+	std::vector<Slot*>& mSlots;
+	QSemaphore&         mFree; //!< Number of free slots.
+	FILE *              mOut;
+};
+
+NdjsonServer::NdjsonServer(const ElementDatabase& db, 
+                           const BatchInput& defaults)
+	: mDB(db), mDefaults(defaults),
+	  mThreadCount(QThread::idealThreadCount()),
+	  mQueueSize(1024),
+	  mCache(0)
+{
+}
+
+void 
+NdjsonServer::setThreadCount(int threads)
+{
+	mThreadCount = threads;
+}
+
+void 
+NdjsonServer::setQueueSize(int requests)
+{
+	mQueueSize = requests;
+}
+
+void 
+NdjsonServer::setResultCache(ResultCache * cache)
+{
+	mCache = cache;
+}
+
+int 
+NdjsonServer::run(std::istream& in, FILE * out)
+{
+	// one more slot for the end mark
+	std::vector<Slot*> ring;
+	int size = (mQueueSize > 0 ? mQueueSize : 1) + 1;
+	for (int i = 0; i < size; i++) ring.push_back(new Slot);
+	QSemaphore free(size), queued(0);
+	QAtomicInt next(0), total(INT_MAX);
+
+	int threads = (mThreadCount > 0 ? mThreadCount : 1);
+	QThreadPool pool;
+	pool.setMaxThreadCount(threads + 1);
+	Writer * writer = new Writer(ring, free, out);
+	writer->setAutoDelete(false);
+	pool.start(writer);
+	for (int i = 0; i < threads; i++) {
+		pool.start(new Worker(mDB, ring, queued, next, total, mCache));
+	}
+
+	int seq = 0;
+	std::string line;
+	while (std::getline(in, line)) 
+	{
+		if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+		free.acquire();
+		Slot& s = *ring[seq % size];
+		s.in = mDefaults;
+		s.id.clear();
+		std::string error;
+		s.valid = parseRequest(line, s.in, s.id, error);
+		if (!s.valid) {
+			s.out = BatchResult();
+			s.out.status = BatchResult::INVALID_INPUT;
+			s.out.error = error;
+		}
+		seq++;
+		queued.release();
+	}
+
+	// mark the end for the writer, let the workers quit
+	free.acquire();
+	ring[seq % size]->end = true;
+	ring[seq % size]->done.release();
+	total = seq;
+	queued.release(threads);
+	pool.waitForDone();
+
+	int failed = writer->mFailed;
+	delete writer;
+	for (int i = 0; i < size; i++) delete ring[i];
+	return failed;
+}
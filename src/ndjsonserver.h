@@ -0,0 +1,91 @@
+/*
+ * src/ndjsonserver.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin, 
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDJSON_SERVER_H
+#define NDJSON_SERVER_H
+
+#include <cstdio>
+#include <iostream>
+#include "batchcalculator.h"
+
+/**
+ * Serves calculation requests as newline-delimited JSON, for use as a
+ * co-process of other programs, e.g. fitting software.
+ *
+ * Each line of the input is a flat JSON object with the keys 
+ * \e "formula" (required), \e "density" (g/cm^3), \e "energy" (keV), 
+ * \e "wavelength" (nm) and \e "id", missing values are taken from the 
+ * defaults:
+ * \code
+ * {"id": 1, "formula": "D2O", "density": 1.107, "energy": 8.048}
+ * \endcode
+ * For each request, a line with a JSON object is written in the same 
+ * order, see printResult(). It starts with the \e "id" of the request,
+ * if there is one. Malformed requests are answered with the status
+ * \e "invalid input".
+ *
+ * Requests are calculated by a pool of worker threads while further
+ * requests are read, the results are written by a thread of their own.
+ * At most queueSize() requests are in progress, reading waits for 
+ * results to be written beyond that. The output is flushed whenever
+ * the next result is not ready yet.
+ */
+class NdjsonServer
+{
+public:
+	/// Creates a server which uses the specified database.
+	/// \param[in] db The element database, it is shared by all workers.
+	/// \param[in] defaults Input values of requests which do not 
+	///            specify them, the X-Ray energy in keV.
+	NdjsonServer(const ElementDatabase& db, const BatchInput& defaults);
+
+	/// Sets the number of worker threads, defaults to the number of 
+	/// processor cores.
+	void setThreadCount(int threads);
+
+	/// Sets the maximum number of requests in progress.
+	void setQueueSize(int requests);
+	int queueSize() const { return mQueueSize; } //!< \see setQueueSize()
+
+	/// Sets a cache of results shared by all workers, it is not used 
+	/// by default.
+	void setResultCache(ResultCache * cache);
+
+	/// Serves all requests until the end of the input.
+	/// \param[in] in Stream of requests.
+	/// \param[in] out Receives the results.
+	/// \returns The number of requests which did not succeed.
+	int run(std::istream& in, FILE * out);
+private:
+	class Slot;
+	class Worker;
+	class Writer;
+
+	const ElementDatabase& mDB;    //!< Shared element database.
+	BatchInput       mDefaults;    //!< Default input values.
+	int              mThreadCount; //!< See setThreadCount().
+	int              mQueueSize;   //!< See setQueueSize().
+	ResultCache *    mCache;       //!< See setResultCache().
+};
+
+#endif
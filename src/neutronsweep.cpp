@@ -0,0 +1,89 @@
+/*
+ * src/neutronsweep.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include "utils.h"
+#include "neutronsweep.h"
+
+NeutronSweep::NeutronSweep()
+	: mNumberDensity(0.0), 
+	  mIncoherent(0.0), mScattering(0.0), mAbsorption0(0.0)
+{
+}
+
+void 
+NeutronSweep::addElement(double weight, double incoherent, 
+                         double scattering, double absorption)
+{
+	// barn -> cm^2
+	mIncoherent  += 1e-24 * weight * incoherent;
+	mScattering  += 1e-24 * weight * scattering;
+	mAbsorption0 += 1e-24 * weight * absorption;
+}
+
+bool 
+NeutronSweep::calculate(const double * wavelengths, int wavelengthCount,
+                        const double * thicknesses, int thicknessCount,
+                        const double * spectrum)
+{
+	mAbsorption.assign(wavelengthCount, 0.0);
+	mTotal.assign(wavelengthCount, 0.0);
+	mTransmission.assign(wavelengthCount * thicknessCount, 0.0);
+	mWeighted.assign(thicknessCount, 0.0);
+	if (wavelengthCount < 1) return true;
+
+	double weightSum = 0.0;
+	for (int i = 0; i < wavelengthCount; i++) {
+		if (wavelengths[i] < 0.0) return false;
+		weightSum += (spectrum ? spectrum[i] : 1.0);
+	}
+	if (weightSum <= 0.0) return false;
+
+	// cross sections per wavelength
+	double absorption = mNumberDensity * mAbsorption0 
+	                    / neutronReferenceWavelength();
+	double scatter = scattering();
+	double * abs = &mAbsorption[0];
+	double * tot = &mTotal[0];
+	for (int i = 0; i < wavelengthCount; i++) {
+		abs[i] = absorption * wavelengths[i];
+		tot[i] = scatter + abs[i];
+	}
+	if (thicknessCount < 1) return true;
+
+	// transmission grid and its weighted average, row by row
+	double * weighted = &mWeighted[0];
+	for (int i = 0; i < wavelengthCount; i++) 
+	{
+		double * row = &mTransmission[i * thicknessCount];
+		double sigma = tot[i];
+		for (int j = 0; j < thicknessCount; j++) {
+			row[j] = exp(-sigma * thicknesses[j]);
+		}
+		double w = (spectrum ? spectrum[i] : 1.0) / weightSum;
+		for (int j = 0; j < thicknessCount; j++) {
+			weighted[j] += w * row[j];
+		}
+	}
+	return true;
+}
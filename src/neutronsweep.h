@@ -0,0 +1,120 @@
+/*
+ * src/neutronsweep.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EDB_NEUTRONSWEEP_H
+#define EDB_NEUTRONSWEEP_H
+
+#include <vector>
+
+/**
+ * Calculates macroscopic neutron cross sections and the transmission of
+ * a compound sample for many wavelengths and thicknesses at once.
+ *
+ * The bound scattering cross sections do not depend on the wavelength.
+ * The absorption cross sections are tabulated for 2200 m/s neutrons and
+ * scale with \f$ 1/v \f$, thus linearly with the wavelength \f$ \lambda \f$:
+ * \f[ \sigma_a(\lambda) = \sigma_a(\lambda_0)\frac{\lambda}{\lambda_0} \f]
+ * The transmission of a sample of thickness \f$ d \f$ is
+ * \f$ T = \exp(-\Sigma_t(\lambda) d) \f$ with the macroscopic total cross
+ * section \f$ \Sigma_t \f$ of scattering and absorption.
+ *
+ * Optionally, the transmission is averaged over all wavelengths weighted
+ * by a spectrum, e.g. the time-of-flight spectrum of an instrument.
+ *
+ * The cross sections and the weighted average are plain loops over
+ * arrays, which GCC vectorizes (the build enables -ftree-vectorize for
+ * this file, see src/CMakeLists.txt). The transmission calls exp() for
+ * each cell of the grid, which stays scalar, there is no portable vector
+ * implementation of it. It dominates the time of a calculation.
+ */
+class NeutronSweep
+{
+public:
+	/// Creates an empty compound.
+	NeutronSweep();
+
+	/// Adds an element of the compound. Cross sections are in barn
+	/// (\f$ 10^{-24} cm^2 \f$).
+	/// \param[in] weight Coefficient of the element in the formula.
+	/// \param[in] incoherent Bound incoherent scattering cross section.
+	/// \param[in] scattering Total bound scattering cross section.
+	/// \param[in] absorption Absorption cross section for 2200 m/s 
+	///            neutrons.
+	void addElement(double weight, double incoherent, 
+	                double scattering, double absorption);
+
+	/// Sets the number of molecules per \f$ cm^3 \f$.
+	void setNumberDensity(double density) { mNumberDensity = density; }
+
+	/// Calculates all values for the specified grid.
+	/// \param[in] wavelengths Neutron wavelengths in nm.
+	/// \param[in] wavelengthCount Number of wavelengths.
+	/// \param[in] thicknesses Sample thicknesses in cm.
+	/// \param[in] thicknessCount Number of thicknesses.
+	/// \param[in] spectrum Optional weight of each wavelength for 
+	///            weightedTransmission(). If 0, all wavelengths are 
+	///            weighted equally.
+	/// \returns False, if a wavelength is negative or the weights of
+	///          the spectrum do not add up to a positive value.
+	bool calculate(const double * wavelengths, int wavelengthCount,
+	               const double * thicknesses, int thicknessCount,
+	               const double * spectrum = 0);
+
+	/// Number of wavelengths of the recent calculation.
+	int wavelengthCount() const { return int(mAbsorption.size()); }
+	/// Number of thicknesses of the recent calculation.
+	int thicknessCount() const { return int(mWeighted.size()); }
+
+	/// Macroscopic incoherent scattering cross section in \f$ cm^{-1} \f$.
+	double incoherent() const { return mNumberDensity * mIncoherent; }
+	/// Macroscopic total scattering cross section in \f$ cm^{-1} \f$.
+	double scattering() const { return mNumberDensity * mScattering; }
+
+	/// Macroscopic absorption cross section in \f$ cm^{-1} \f$ for
+	/// each wavelength.
+	const double * absorption() const { return data(mAbsorption); }
+	/// Macroscopic total cross section (scattering and absorption) in
+	/// \f$ cm^{-1} \f$ for each wavelength.
+	const double * total() const { return data(mTotal); }
+	/// Transmission for each wavelength (row) and thickness (column),
+	/// thicknessCount() values per row.
+	const double * transmission() const { return data(mTransmission); }
+	/// Transmission for each thickness, averaged over all wavelengths
+	/// weighted by the spectrum.
+	const double * weightedTransmission() const { return data(mWeighted); }
+private:
+	static const double * data(const std::vector<double>& v) {
+		return v.empty() ? 0 : &v[0];
+	}
+
+	double              mNumberDensity; //!< Molecules per cm^3.
+	double              mIncoherent;    //!< Molecular cross section, cm^2.
+	double              mScattering;    //!< Molecular cross section, cm^2.
+	double              mAbsorption0;   //!< Molecular cross section, cm^2.
+	std::vector<double> mAbsorption;    //!< See absorption().
+	std::vector<double> mTotal;         //!< See total().
+	std::vector<double> mTransmission;  //!< See transmission().
+	std::vector<double> mWeighted;      //!< See weightedTransmission().
+};
+
+#endif
@@ -0,0 +1,264 @@
+/*
+ * src/resultcache.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <QFile>
+#include <QDataStream>
+#include <QMutexLocker>
+#include "resultcache.h"
+
+const quint32 ResultCache::MAGIC_NUMBER   = 0x51535243; // "QSRC"
+const quint32 ResultCache::FORMAT_VERSION = 2;
+
+static void 
+writeComplex(QDataStream& out, const complex& c)
+{
+	out << c.real() << c.imag();
+}
+
+static complex 
+readComplex(QDataStream& in)
+{
+	double re = 0.0, im = 0.0;
+	in >> re >> im;
+	return complex(re, im);
+}
+
+/// Writes a single result, see ResultCache for the layout.
+static void 
+writeResult(QDataStream& out, const CalcResult& r)
+{
+	out << r.density << r.xrayEnergy << r.neutronWavelength
+	    << quint32(r.partials.size());
+	for (size_t i = 0; i < r.partials.size(); i++) 
+	{
+		const CalcResult::Partial& p = r.partials[i];
+		out << QByteArray(p.name.c_str())
+		    << p.electrons << p.mass << p.massRatio << p.volume;
+		writeComplex(out, p.nslCoherent);
+		writeComplex(out, p.nslIncoherent);
+		writeComplex(out, p.sldCoherent);
+		writeComplex(out, p.sldIncoherent);
+		out << quint8(p.hasXray) << p.fp << p.fpp;
+		writeComplex(out, p.sldXray);
+	}
+	out << r.electrons << r.mass << r.volume;
+	writeComplex(out, r.nslCoherent);
+	writeComplex(out, r.nslIncoherent);
+	writeComplex(out, r.sldCoherent);
+	writeComplex(out, r.sldIncoherent);
+	out << quint8(r.hasCrossSections) 
+	    << r.absorption << r.incoherent << r.total << r.transmission
+	    << qint32(r.xrayStatus) << r.fp << r.fpp;
+	writeComplex(out, r.sldXray);
+}
+
+/// Reads a single result, see ResultCache for the layout.
+/// \returns False if the stream is not valid.
+static bool 
+readResult(QDataStream& in, CalcResult& r)
+{
+	quint32 count = 0;
+	in >> r.density >> r.xrayEnergy >> r.neutronWavelength >> count;
+	if (in.status() != QDataStream::Ok) return false;
+	r.partials.clear();
+	for (quint32 i = 0; i < count; i++) 
+	{
+		CalcResult::Partial p;
+		QByteArray name;
+		quint8 hasXray = 0;
+		in >> name >> p.electrons >> p.mass >> p.massRatio >> p.volume;
+		p.name = name.constData();
+		p.nslCoherent = readComplex(in);
+		p.nslIncoherent = readComplex(in);
+		p.sldCoherent = readComplex(in);
+		p.sldIncoherent = readComplex(in);
+		in >> hasXray >> p.fp >> p.fpp;
+		p.hasXray = (hasXray != 0);
+		p.sldXray = readComplex(in);
+		if (in.status() != QDataStream::Ok) return false;
+		r.partials.push_back(p);
+	}
+	quint8 hasCrossSections = 0;
+	qint32 xrayStatus = 0;
+	in >> r.electrons >> r.mass >> r.volume;
+	r.nslCoherent = readComplex(in);
+	r.nslIncoherent = readComplex(in);
+	r.sldCoherent = readComplex(in);
+	r.sldIncoherent = readComplex(in);
+	in >> hasCrossSections 
+	   >> r.absorption >> r.incoherent >> r.total >> r.transmission
+	   >> xrayStatus >> r.fp >> r.fpp;
+	r.sldXray = readComplex(in);
+	r.hasCrossSections = (hasCrossSections != 0);
+	if (xrayStatus < XraySpan::EXACT || xrayStatus > XraySpan::NO_DATA) {
+		return false;
+	}
+	r.xrayStatus = XraySpan::Status(xrayStatus);
+	return in.status() == QDataStream::Ok;
+}
+
+ResultCache::ResultCache(int maxBytes)
+	: mCache(maxBytes),
+	  mRevision(-1)
+{
+}
+
+void 
+ResultCache::setMaxBytes(int maxBytes)
+{
+	QMutexLocker lock(&mMutex);
+	mCache.setMaxCost(maxBytes);
+}
+
+int 
+ResultCache::maxBytes() const
+{
+	QMutexLocker lock(&mMutex);
+	return mCache.maxCost();
+}
+
+int 
+ResultCache::size() const
+{
+	QMutexLocker lock(&mMutex);
+	return mCache.size();
+}
+
+QByteArray 
+ResultCache::makeKey(const std::string& empirical, const CalcResult& inputs)
+{
+	const double values[] = { inputs.density, inputs.xrayEnergy, 
+	                          inputs.neutronWavelength };
+	QByteArray key(empirical.data(), int(empirical.size()));
+	key.append('\0');
+	// most significant byte first, independent of the host
+	for (int i = 0; i < 3; i++) {
+		quint64 bits;
+		memcpy(&bits, &values[i], sizeof(bits));
+		for (int shift = 56; shift >= 0; shift -= 8) {
+			key.append(char(bits >> shift));
+		}
+	}
+	return key;
+}
+
+void 
+ResultCache::setRevision(int revision)
+{
+	QMutexLocker lock(&mMutex);
+	// the first revision reported is the one of loaded results
+	if (mRevision >= 0 && revision != mRevision) {
+		mCache.clear();
+	}
+	mRevision = revision;
+}
+
+bool 
+ResultCache::find(const QByteArray& key, CalcResult& r) const
+{
+	QMutexLocker lock(&mMutex);
+	const CalcResult * cached = mCache.object(key);
+	if (!cached) return false;
+	r = *cached;
+	return true;
+}
+
+void 
+ResultCache::insert(const QByteArray& key, const CalcResult& r)
+{
+	int c = cost(key, r);
+	QMutexLocker lock(&mMutex);
+	mCache.insert(key, new CalcResult(r), c);
+}
+
+void 
+ResultCache::clear()
+{
+	QMutexLocker lock(&mMutex);
+	mCache.clear();
+}
+
+int 
+ResultCache::cost(const QByteArray& key, const CalcResult& r)
+{
+	int bytes = int(sizeof(CalcResult)) + key.size();
+	for (size_t i = 0; i < r.partials.size(); i++) {
+		bytes += int(sizeof(CalcResult::Partial) + r.partials[i].name.size());
+	}
+	return bytes;
+}
+
+bool 
+ResultCache::load(const QString& filename, quint64 fingerprint)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly)) return false;
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_4_5);
+
+	quint32 magic = 0, version = 0, count = 0;
+	quint64 print = 0;
+	in >> magic >> version >> print >> count;
+	if (in.status() != QDataStream::Ok || magic != MAGIC_NUMBER || 
+	    version != FORMAT_VERSION || print != fingerprint) 
+	{
+		return false;
+	}
+	// read everything before adding anything
+	QList<QByteArray> keys;
+	QList<CalcResult> results;
+	for (quint32 i = 0; i < count; i++) {
+		QByteArray key;
+		CalcResult r;
+		in >> key;
+		if (!readResult(in, r)) return false;
+		keys << key;
+		results << r;
+	}
+	for (int i = 0; i < keys.size(); i++) {
+		insert(keys.at(i), results.at(i));
+	}
+	return true;
+}
+
+bool 
+ResultCache::save(const QString& filename, quint64 fingerprint) const
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		return false;
+	}
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_4_5);
+
+	QMutexLocker lock(&mMutex);
+	QList<QByteArray> keys(mCache.keys());
+	out << MAGIC_NUMBER << FORMAT_VERSION << fingerprint 
+	    << quint32(keys.size());
+	foreach(const QByteArray& key, keys) {
+		out << key;
+		writeResult(out, *mCache.object(key));
+	}
+	return out.status() == QDataStream::Ok;
+}
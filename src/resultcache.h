@@ -0,0 +1,151 @@
+/*
+ * src/resultcache.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <string>
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QString>
+#include "calcresult.h"
+
+/**
+ * Memoizes results of the compound calculation. A result is identified
+ * by the canonical empirical formula and the input values density, X-Ray
+ * energy and neutron wavelength, see makeKey(). The least recently used
+ * results are dropped when the approximate memory used exceeds the 
+ * configured bound.
+ *
+ * All cached results depend on the content of the element database.
+ * Users report its ElementDatabase::revision() by setRevision() before
+ * each lookup, the cache is emptied when it changes. 
+ *
+ * All methods are thread-safe, a single cache may be shared by the
+ * calculators of all threads.
+ *
+ * The cache may be saved to a file and restored later. The file is
+ * rejected if it was created from different element data, see
+ * ElementDatabase::fingerprint(). Layout (QDataStream, big endian):
+ * \code
+ * quint32  magic number ("QSRC")
+ * quint32  format version, see FORMAT_VERSION
+ * quint64  fingerprint of the element database
+ * quint32  number of results
+ * <per result>
+ *     QByteArray  key, see makeKey()
+ *     double      density, X-Ray energy, neutron wavelength
+ *     quint32     number of partial results
+ *     <per partial result>  
+ *                 name, electrons, mass, mass ratio, volume,
+ *                 NSL and SLD coherent and incoherent, X-Ray flag,
+ *                 f', f'', X-Ray SLD
+ *     <totals>    all further members of CalcResult in declaration order
+ * \endcode
+ * Complex values are stored as two doubles: real and imaginary part.
+ */
+class ResultCache
+{
+	/// Identifies a result cache file.
+	static const quint32 MAGIC_NUMBER;
+	/// Version of the file layout. Has to be increased on every change
+	/// of the layout described above.
+	static const quint32 FORMAT_VERSION;
+public:
+	/// Creates an empty cache.
+	/// \param[in] maxBytes Upper bound of the memory used in bytes,
+	///            see setMaxBytes().
+	explicit ResultCache(int maxBytes = 16*1024*1024);
+
+	/// Sets the upper bound of the memory used by all cached results.
+	/// Drops least recently used results if it is exceeded.
+	/// \param[in] maxBytes Approximate size in bytes.
+	void setMaxBytes(int maxBytes);
+
+	/// Returns the upper bound of the memory used, see setMaxBytes().
+	int maxBytes() const;
+
+	/// Returns the number of cached results.
+	int size() const;
+
+	/// Generates the key of a result: the formula, a null character and
+	/// the three input values as doubles in big endian byte order, like
+	/// QDataStream writes them. Keys of saved results are valid on all
+	/// hosts.
+	/// \param[in] empirical Canonical empirical formula as printed for
+	///            cfp::Parser::empirical().
+	/// \param[in] inputs Provides the input values density, X-Ray energy
+	///            and neutron wavelength.
+	static QByteArray makeKey(const std::string& empirical, 
+	                          const CalcResult&  inputs);
+
+	/// Reports the revision of the element database the following 
+	/// results are calculated from. All cached results are dropped if it
+	/// differs from the previous revision.
+	/// \param[in] revision See ElementDatabase::revision().
+	void setRevision(int revision);
+
+	/// Retrieves a cached result.
+	/// \param[in] key See makeKey().
+	/// \param[out] r Receives the result, unchanged if there is none.
+	/// \returns True, if the result was found.
+	bool find(const QByteArray& key, CalcResult& r) const;
+
+	/// Adds a result to the cache, replaces a previous one with the 
+	/// same key.
+	/// \param[in] key See makeKey().
+	/// \param[in] r The result to add.
+	void insert(const QByteArray& key, const CalcResult& r);
+
+	/// Drops all cached results.
+	void clear();
+
+	/// Adds all results from a file created by save(). 
+	/// \param[in] filename File to read.
+	/// \param[in] fingerprint Of the current element database, see 
+	///            ElementDatabase::fingerprint().
+	/// \returns False if the file is missing, outdated, invalid or was
+	///          created from different element data. Nothing is added 
+	///          then.
+	bool load(const QString& filename, quint64 fingerprint);
+
+	/// Writes all cached results to a file.
+	/// \param[in] filename File to create.
+	/// \param[in] fingerprint Of the element database the results were
+	///            calculated from, see ElementDatabase::fingerprint().
+	/// \returns True on success, false otherwise.
+	bool save(const QString& filename, quint64 fingerprint) const;
+private:
+	/// Estimates the memory used by a cached result.
+	static int cost(const QByteArray& key, const CalcResult& r);
+private:
+	/// Cached results by key, ordered by recent use.
+	typedef QCache<QByteArray, CalcResult> CacheType;
+
+	mutable QMutex mMutex;    //!< Guards all members below.
+	mutable CacheType mCache; //!< Lookups reorder the results.
+	int    mRevision;         //!< Recent database revision or -1.
+};
+
+#endif
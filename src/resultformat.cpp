@@ -0,0 +1,296 @@
+/*
+ * src/resultformat.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin, 
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "resultformat.h"
+
+namespace {
+
+/// Names of the columns of a result row, also used as JSON keys.
+const char * const COLUMNS[] = {
+	"formula", "status", "electrons", "mass", "volume",
+	"sld_coherent_re", "sld_coherent_im", 
+	"sld_incoherent_re", "sld_incoherent_im",
+	"sld_xray_re", "sld_xray_im", "error"
+};
+const int COLUMN_COUNT = sizeof(COLUMNS) / sizeof(COLUMNS[0]);
+
+/// Names of the columns of a contrast variation row.
+const char * const CONTRAST_COLUMNS[] = {
+	"formula", "status", "d2o", "sld_re", "sld_im", "solvent_sld",
+	"contrast", "match_d2o", "error"
+};
+const int CONTRAST_COLUMN_COUNT = 
+	sizeof(CONTRAST_COLUMNS) / sizeof(CONTRAST_COLUMNS[0]);
+
+/// Names of the columns of a mixture row, the first six and the last 
+/// one belong to the component.
+const char * const MIXTURE_COLUMNS[] = {
+	"formula", "status", "amount", 
+	"mass_fraction", "volume_fraction", "mole_fraction", 
+	"density", "sld_coherent_re", "sld_coherent_im",
+	"sld_incoherent_re", "sld_incoherent_im",
+	"sld_xray_re", "sld_xray_im", "incoherent_background", 
+	"transmission", "error"
+};
+const int MIXTURE_COLUMN_COUNT = 
+	sizeof(MIXTURE_COLUMNS) / sizeof(MIXTURE_COLUMNS[0]);
+
+/// Writes a floating point number, JSON has no representation for
+/// infinite or undefined values.
+void 
+printNumber(FILE * out, double value, bool json)
+{
+	if (json && (value != value || std::fabs(value) > 1.7e308)) {
+		fputs("null", out);
+	} else {
+		fprintf(out, "%.10g", value);
+	}
+}
+
+const char * 
+statusName(BatchResult::Status status)
+{
+	switch (status) {
+		case BatchResult::OK:              return "ok";
+		case BatchResult::PARSE_ERROR:     return "parse error";
+		case BatchResult::UNKNOWN_ELEMENT: return "unknown element";
+		case BatchResult::INVALID_INPUT:   return "invalid input";
+	}
+	return "";
+}
+
+/// Writes the first columns of a mixture row, those of the component.
+void 
+printComponent(FILE * out, const BatchInput& in, const BatchResult& r, 
+               double amount, const Mixture& mixture, int index, 
+               bool valid, bool json)
+{
+	double fractions[] = { mixture.massFraction(index),
+		mixture.volumeFraction(index), mixture.moleFraction(index) };
+	const char * sep = (json ? ", " : ",");
+
+	if (json) fprintf(out, "\"%s\": ", MIXTURE_COLUMNS[0]);
+	printString(out, in.formula.constData(), json);
+	fputs(sep, out);
+	if (json) fprintf(out, "\"%s\": ", MIXTURE_COLUMNS[1]);
+	printString(out, statusName(r.status), json);
+	fputs(sep, out);
+	if (json) fprintf(out, "\"%s\": ", MIXTURE_COLUMNS[2]);
+	printNumber(out, amount, json);
+	for (int i = 0; i < 3; i++) {
+		fputs(sep, out);
+		if (json) fprintf(out, "\"%s\": ", MIXTURE_COLUMNS[i+3]);
+		if (valid) printNumber(out, fractions[i], json);
+		else if (json) fputs("null", out);
+	}
+}
+
+} // namespace
+
+void 
+printString(FILE * out, const char * str, bool json)
+{
+	fputc('"', out);
+	for (; *str; str++) {
+		if (*str == '"') fputs(json ? "\\\"" : "\"\"", out);
+		else if (json && *str == '\\') fputs("\\\\", out);
+		else if (json && (unsigned char)(*str) < 0x20) {
+			fprintf(out, "\\u%04x", *str);
+		}
+		else fputc(*str, out);
+	}
+	fputc('"', out);
+}
+
+void 
+printResultHeader(FILE * out)
+{
+	for (int i = 0; i < COLUMN_COUNT; i++) {
+		fprintf(out, "%s%c", COLUMNS[i], i+1 < COLUMN_COUNT ? ',' : '\n');
+	}
+}
+
+void 
+printResult(FILE * out, const BatchInput& in, const BatchResult& r, 
+            bool json, const std::string& id)
+{
+	bool ok = (r.status == BatchResult::OK);
+	bool xray = ok && (r.xrayStatus == XraySpan::EXACT || 
+	                   r.xrayStatus == XraySpan::INTERPOLATED);
+	double values[] = { r.electrons, r.mass, r.volume,
+		r.sldCoherent.real(), r.sldCoherent.imag(),
+		r.sldIncoherent.real(), r.sldIncoherent.imag(),
+		r.sldXray.real(), r.sldXray.imag() };
+	const char * sep = (json ? ", " : ",");
+
+	if (json) {
+		fputc('{', out);
+		if (!id.empty()) fprintf(out, "\"id\": %s, ", id.c_str());
+		fprintf(out, "\"%s\": ", COLUMNS[0]);
+	}
+	printString(out, in.formula.constData(), json);
+	fputs(sep, out);
+	if (json) fprintf(out, "\"%s\": ", COLUMNS[1]);
+	printString(out, statusName(r.status), json);
+	for (int i = 0; i < 9; i++) {
+		fputs(sep, out);
+		if (json) fprintf(out, "\"%s\": ", COLUMNS[i+2]);
+		bool valid = ok && (i < 7 || xray);
+		if (valid) printNumber(out, values[i], json);
+		else if (json) fputs("null", out);
+	}
+	fputs(sep, out);
+	if (json) fprintf(out, "\"%s\": ", COLUMNS[COLUMN_COUNT-1]);
+	printString(out, r.error.c_str(), json);
+	fputs(json ? "}\n" : "\n", out);
+}
+
+void 
+printContrastHeader(FILE * out)
+{
+	for (int i = 0; i < CONTRAST_COLUMN_COUNT; i++) {
+		fprintf(out, "%s%c", CONTRAST_COLUMNS[i], 
+		        i+1 < CONTRAST_COLUMN_COUNT ? ',' : '\n');
+	}
+}
+
+void 
+printContrast(FILE * out, const BatchInput& in, const BatchResult& r,
+              const std::vector<double>& d2o, 
+              const DeuterationSeries& series, bool json)
+{
+	bool ok = (r.status == BatchResult::OK);
+	double match = 0.0;
+	bool matched = ok && series.matchPoint(match);
+	int count = (ok ? std::min(int(d2o.size()), series.size()) : 0);
+	const double * columns[] = { d2o.empty() ? 0 : &d2o[0], 
+		series.sldReal(), series.sldImag(), series.solventSld(), 
+		series.contrast() };
+
+	if (json) 
+	{
+		fprintf(out, "{\"%s\": ", CONTRAST_COLUMNS[0]);
+		printString(out, in.formula.constData(), json);
+		fprintf(out, ", \"%s\": ", CONTRAST_COLUMNS[1]);
+		printString(out, statusName(r.status), json);
+		for (int c = 0; c < 5; c++) {
+			fprintf(out, ", \"%s\": [", CONTRAST_COLUMNS[c+2]);
+			for (int i = 0; i < count; i++) {
+				if (i > 0) fputs(", ", out);
+				printNumber(out, columns[c][i], json);
+			}
+			fputc(']', out);
+		}
+		fprintf(out, ", \"%s\": ", CONTRAST_COLUMNS[7]);
+		if (matched) printNumber(out, match, json);
+		else fputs("null", out);
+		fprintf(out, ", \"%s\": ", CONTRAST_COLUMNS[8]);
+		printString(out, r.error.c_str(), json);
+		fputs("}\n", out);
+		return;
+	}
+
+	// at least one line, to report errors
+	for (int i = 0; i < std::max(count, 1); i++) 
+	{
+		printString(out, in.formula.constData(), json);
+		fputc(',', out);
+		printString(out, statusName(r.status), json);
+		for (int c = 0; c < 5; c++) {
+			fputc(',', out);
+			if (i < count) printNumber(out, columns[c][i], json);
+		}
+		fputc(',', out);
+		if (matched) printNumber(out, match, json);
+		fputc(',', out);
+		printString(out, r.error.c_str(), json);
+		fputc('\n', out);
+	}
+}
+
+void 
+printMixtureHeader(FILE * out)
+{
+	for (int i = 0; i < MIXTURE_COLUMN_COUNT; i++) {
+		fprintf(out, "%s%c", MIXTURE_COLUMNS[i], 
+		        i+1 < MIXTURE_COLUMN_COUNT ? ',' : '\n');
+	}
+}
+
+void 
+printMixture(FILE * out, const std::vector<BatchInput>& in, 
+             const std::vector<BatchResult>& r, 
+             const std::vector<double>& amounts,
+             const Mixture& mixture, bool valid, double wavelength,
+             bool json)
+{
+	int count = int(std::min(in.size(), std::min(r.size(), amounts.size())));
+	double values[] = { mixture.density(), 
+		mixture.sldCoherent().real(), mixture.sldCoherent().imag(),
+		mixture.sldIncoherent().real(), mixture.sldIncoherent().imag(),
+		mixture.sldXray().real(), mixture.sldXray().imag(),
+		mixture.incoherentBackground(), 
+		mixture.transmission(wavelength, 0.1) }; // 1 mm
+	bool available[9];
+	for (int c = 0; c < 9; c++) {
+		available[c] = valid && (c < 5 ||
+			(c < 7 ? mixture.hasXray() : mixture.hasCrossSections()));
+	}
+
+	if (json) 
+	{
+		fputs("{\"components\": [", out);
+		for (int i = 0; i < count; i++) {
+			fputs(i > 0 ? ", {" : "{", out);
+			printComponent(out, in[i], r[i], amounts[i], mixture, i, 
+			               valid, json);
+			fprintf(out, ", \"%s\": ", 
+			        MIXTURE_COLUMNS[MIXTURE_COLUMN_COUNT-1]);
+			printString(out, r[i].error.c_str(), json);
+			fputc('}', out);
+		}
+		fputc(']', out);
+		for (int c = 0; c < 9; c++) {
+			fprintf(out, ", \"%s\": ", MIXTURE_COLUMNS[c+6]);
+			if (available[c]) printNumber(out, values[c], json);
+			else fputs("null", out);
+		}
+		fputs("}\n", out);
+		return;
+	}
+
+	for (int i = 0; i < count; i++) 
+	{
+		printComponent(out, in[i], r[i], amounts[i], mixture, i, 
+		               valid, json);
+		for (int c = 0; c < 9; c++) {
+			fputc(',', out);
+			if (available[c]) printNumber(out, values[c], json);
+		}
+		fputc(',', out);
+		printString(out, r[i].error.c_str(), json);
+		fputc('\n', out);
+	}
+}
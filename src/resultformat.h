@@ -0,0 +1,94 @@
+/*
+ * src/resultformat.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin, 
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESULT_FORMAT_H
+#define RESULT_FORMAT_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "batchcalculator.h"
+#include "deuterationseries.h"
+#include "mixture.h"
+
+/// Writes the CSV header line of the columns written by printResult().
+/// \param[in] out Stream to write to.
+void printResultHeader(FILE * out);
+
+/// Writes the result of a row as a CSV line or as a JSON object on a 
+/// line of its own. Values which are not available are left empty or 
+/// are \e null.
+/// \param[in] out Stream to write to.
+/// \param[in] in The input row.
+/// \param[in] r Its result.
+/// \param[in] json Writes JSON if true, CSV otherwise.
+/// \param[in] id JSON value written with the key \e "id" first, 
+///            omitted if empty. JSON only.
+void printResult(FILE * out, const BatchInput& in, const BatchResult& r, 
+                 bool json, const std::string& id = std::string());
+
+/// Writes the CSV header line of the columns written by printContrast().
+/// \param[in] out Stream to write to.
+void printContrastHeader(FILE * out);
+
+/// Writes the contrast variation of a row. As CSV, it writes one line 
+/// per \f$ D_2O \f$ fraction, the match point is repeated on each. As
+/// JSON, it writes one object with an array per column.
+/// \param[in] out Stream to write to.
+/// \param[in] in The input row.
+/// \param[in] r Its result.
+/// \param[in] d2o Fractions of \f$ D_2O \f$ in the solvent.
+/// \param[in] series The contrast variation calculated for \e d2o.
+/// \param[in] json Writes JSON if true, CSV otherwise.
+void printContrast(FILE * out, const BatchInput& in, const BatchResult& r,
+                   const std::vector<double>& d2o, 
+                   const DeuterationSeries& series, bool json);
+
+/// Writes the CSV header line of the columns written by printMixture().
+/// \param[in] out Stream to write to.
+void printMixtureHeader(FILE * out);
+
+/// Writes the components of a mixture and its properties. As CSV, it 
+/// writes one line per component with its fractions, the properties of 
+/// the mixture are repeated on each. As JSON, it writes one object with
+/// an array of the components.
+/// \param[in] out Stream to write to.
+/// \param[in] in The input rows of the components.
+/// \param[in] r Their results.
+/// \param[in] amounts Amounts of the components.
+/// \param[in] mixture The mixture of the components.
+/// \param[in] valid Mixture::calculate() succeeded, the fractions and 
+///            properties are left empty or are \e null otherwise.
+/// \param[in] wavelength Neutron wavelength in nm of the transmission,
+///            which is given for a thickness of 1 mm.
+/// \param[in] json Writes JSON if true, CSV otherwise.
+void printMixture(FILE * out, const std::vector<BatchInput>& in, 
+                  const std::vector<BatchResult>& r, 
+                  const std::vector<double>& amounts,
+                  const Mixture& mixture, bool valid, double wavelength,
+                  bool json);
+
+/// Writes a character string quoted and escaped for CSV or JSON.
+void printString(FILE * out, const char * str, bool json);
+
+#endif
@@ -0,0 +1,248 @@
+/*
+ * src/staticelementtable.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <limits>
+#include <QFile>
+#include <QHash>
+#include "staticelementtable.h"
+#include "elementdatabase.h"
+#include "elementtable.h"
+
+StaticElementTable::StaticElementTable()
+{
+}
+
+StaticElementTable::~StaticElementTable()
+{
+}
+
+const StaticElementTable::ElementPtrList&
+StaticElementTable::read(const StaticElementRecord * records, int count)
+{
+	mResultList.clear();
+	for(int i=0; i < count; i++)
+	{
+		Element * e = readElement(records[i]);
+		if (e) mResultList.push_back(e);
+	}
+	return mResultList;
+}
+
+/// Returns true if the record has data for the property.
+static bool isPresent(const StaticElementRecord& rec, Element::Property p)
+{
+	return (rec.present & (1u << p)) != 0;
+}
+
+Element *
+StaticElementTable::readElement(const StaticElementRecord& rec)
+{
+	Element * e = new Element();
+	if (isPresent(rec, Element::SYMBOL_PROPERTY)) {
+		e->setProperty(Element::SYMBOL_PROPERTY, std::string(rec.symbol));
+	}
+	if (isPresent(rec, Element::NAME_PROPERTY)) {
+		e->setProperty(Element::NAME_PROPERTY, std::string(rec.name));
+	}
+	if (isPresent(rec, Element::NUCLEONS_PROPERTY)) {
+		e->setProperty(Element::NUCLEONS_PROPERTY, rec.nucleons);
+	}
+	if (isPresent(rec, Element::ELECTRONS_PROPERTY)) {
+		e->setProperty(Element::ELECTRONS_PROPERTY, rec.electrons);
+	}
+	if (isPresent(rec, Element::ATOMIC_MASS_PROPERTY)) {
+		e->setProperty(Element::ATOMIC_MASS_PROPERTY, rec.atomicMass);
+	}
+	if (isPresent(rec, Element::ABUNDANCE_PROPERTY)) {
+		e->setProperty(Element::ABUNDANCE_PROPERTY, rec.abundance);
+	}
+	if (isPresent(rec, Element::NS_L_COHERENT_PROPERTY)) {
+		e->setProperty(Element::NS_L_COHERENT_PROPERTY,
+			complex(rec.nslCoherent[0], rec.nslCoherent[1]));
+	}
+	if (isPresent(rec, Element::NS_L_INCOHERENT_PROPERTY)) {
+		e->setProperty(Element::NS_L_INCOHERENT_PROPERTY,
+			complex(rec.nslIncoherent[0], rec.nslIncoherent[1]));
+	}
+	if (isPresent(rec, Element::NS_CS_COHERENT_PROPERTY)) {
+		e->setProperty(Element::NS_CS_COHERENT_PROPERTY, rec.nsCsCoherent);
+	}
+	if (isPresent(rec, Element::NS_CS_INCOHERENT_PROPERTY)) {
+		e->setProperty(Element::NS_CS_INCOHERENT_PROPERTY,
+			rec.nsCsIncoherent);
+	}
+	if (isPresent(rec, Element::NS_CS_TOTAL_PROPERTY)) {
+		e->setProperty(Element::NS_CS_TOTAL_PROPERTY, rec.nsCsTotal);
+	}
+	if (isPresent(rec, Element::NS_CS_ABSORPTION_PROPERTY)) {
+		e->setProperty(Element::NS_CS_ABSORPTION_PROPERTY,
+			rec.nsCsAbsorption);
+	}
+	if (rec.xrayCount > 0) {
+		e->setXrayCoefficients(XraySpan(
+			rec.xrayEnergy, rec.xrayFp, rec.xrayFpp, rec.xrayCount));
+	}
+	if (!e->isValid()) {
+		delete e;
+		return NULL;
+	}
+	return e;
+}
+
+// source generation //
+
+/// Returns a property value of an element, its default value if the
+/// property has no data of the requested type.
+template<typename T>
+static T value(const Element& e, Element::Property p, const T& def)
+{
+	T val = def;
+	e.table().get(p, e.id(), val);
+	return val;
+}
+
+/// Formats a floating point number as C++ literal without loss.
+/// NaN and infinity have no literal, they are written as expressions
+/// of std::numeric_limits.
+static QByteArray literal(double d)
+{
+	if (d != d) {
+		return "std::numeric_limits<double>::quiet_NaN()";
+	}
+	if (d > std::numeric_limits<double>::max()) {
+		return "std::numeric_limits<double>::infinity()";
+	}
+	if (d < -std::numeric_limits<double>::max()) {
+		return "-std::numeric_limits<double>::infinity()";
+	}
+	QByteArray str(QByteArray::number(d, 'g', 17));
+	if (!str.contains('.') && !str.contains('e')) {
+		str += ".0";
+	}
+	return str;
+}
+
+/// Formats a character string as C++ literal.
+static QByteArray literal(const std::string& s)
+{
+	QByteArray str("\"");
+	for(std::string::const_iterator c = s.begin(); c != s.end(); c++) {
+		if (*c == '"' || *c == '\\') str += '\\';
+		str += *c;
+	}
+	return str + "\"";
+}
+
+/// Formats a complex number as initializer of a two element array.
+static QByteArray literal(const complex& c)
+{
+	return "{ " + literal(c.real()) + ", " + literal(c.imag()) + " }";
+}
+
+bool
+StaticElementTable::write(const QString& filename, const ElementDatabase& db)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		return false;
+	}
+	QStringList keys(db.getSymbolList());
+	QList<const Element *> elements;
+	foreach(const QString& key, keys) {
+		ElementDatabase::Iterator it = db.find(key);
+		if (it == db.end() || !it.value()) return false;
+		elements << it.value();
+	}
+
+	file.write(
+		"// Generated by qsldcalc-datacompiler from the XML element data\n"
+		"// files, do not edit. See StaticElementTable.\n\n"
+		"#include <limits>\n"
+		"#include \"staticelementtable.h\"\n");
+	// all X-Ray scattering factors as one array per column,
+	// each distinct energy grid is written once
+	const char * columns[] = { "xrayEnergy", "xrayFp", "xrayFpp" };
+	QList<int> offsets, gridOffsets;
+	for(int col=0; col < 3; col++) {
+		file.write(QByteArray("\nstatic const double ") + columns[col] +
+		           "[] = {\n");
+		QHash<QByteArray, int> grids;
+		int offset = 0;
+		foreach(const Element * e, elements) {
+			XraySpan xray = e->xrayCoefficients();
+			const double * values = (col == 0) ? xray.energies() :
+			                        (col == 1) ? xray.fps() : xray.fpps();
+			if (col == 0) {
+				const QByteArray grid(reinterpret_cast<const char *>(values),
+				                      xray.size() * int(sizeof(double)));
+				if (grids.contains(grid)) {
+					gridOffsets << grids.value(grid);
+					continue;
+				}
+				grids.insert(grid, offset);
+				gridOffsets << offset;
+			} else if (col == 1) {
+				offsets << offset;
+			}
+			for(int i=0; i < xray.size(); i++) {
+				file.write("\t" + literal(values[i]) + ",\n");
+			}
+			offset += xray.size();
+		}
+		// never empty
+		file.write("\t0.0\n};\n");
+	}
+	file.write("\nconst StaticElementRecord staticElementRecords[] = {\n");
+	for(int i=0; i < elements.size(); i++) {
+		const Element& e = *elements.at(i);
+		const int xrayCount = e.xrayCoefficients().size();
+		unsigned int present = 0;
+		for(int p=0; p < Element::INVALID_PROPERTY; p++) {
+			if (e.table().hasValue(Element::Property(p), e.id())) {
+				present |= 1u << p;
+			}
+		}
+		file.write("\t{ " +
+			literal(value(e, Element::SYMBOL_PROPERTY, std::string())) + ", " +
+			literal(value(e, Element::NAME_PROPERTY, std::string())) + ", " +
+			QByteArray::number(value(e, Element::NUCLEONS_PROPERTY, 0)) + ", " +
+			QByteArray::number(value(e, Element::ELECTRONS_PROPERTY, 0)) + ", " +
+			literal(value(e, Element::ATOMIC_MASS_PROPERTY, 0.0)) + ", " +
+			literal(value(e, Element::ABUNDANCE_PROPERTY, 0.0)) + ",\n\t  " +
+			literal(value(e, Element::NS_L_COHERENT_PROPERTY, complex())) + ", " +
+			literal(value(e, Element::NS_L_INCOHERENT_PROPERTY, complex())) + ",\n\t  " +
+			literal(value(e, Element::NS_CS_COHERENT_PROPERTY, 0.0)) + ", " +
+			literal(value(e, Element::NS_CS_INCOHERENT_PROPERTY, 0.0)) + ", " +
+			literal(value(e, Element::NS_CS_TOTAL_PROPERTY, 0.0)) + ", " +
+			literal(value(e, Element::NS_CS_ABSORPTION_PROPERTY, 0.0)) + ",\n\t  " +
+			"xrayEnergy + " + QByteArray::number(gridOffsets.at(i)) +
+			", xrayFp + " + QByteArray::number(offsets.at(i)) +
+			", xrayFpp + " + QByteArray::number(offsets.at(i)) + ", " +
+			QByteArray::number(xrayCount) + ",\n\t  0x" +
+			QByteArray::number(present, 16) + "u },\n");
+	}
+	file.write("};\n\nconst int staticElementRecordCount = " +
+		QByteArray::number(elements.size()) + ";\n");
+	return file.error() == QFile::NoError;
+}
+
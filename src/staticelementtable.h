@@ -0,0 +1,120 @@
+/*
+ * src/staticelementtable.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATIC_ELEMENT_TABLE_H
+#define STATIC_ELEMENT_TABLE_H
+
+#include "xmlparser.h"
+
+class ElementDatabase;
+struct StaticElementRecord;
+
+/// Table of all elements, defined by the generated source.
+/// \sa StaticElementTable
+extern const StaticElementRecord staticElementRecords[];
+/// Number of records in staticElementRecords.
+extern const int staticElementRecordCount;
+
+/// Plain data of a single element, suitable for static initialization.
+/// The members correspond to Element::Property, complex numbers are
+/// stored as real and imaginary part. Members of properties without
+/// data are zero and their bit in \e present is cleared.
+struct StaticElementRecord
+{
+	const char * symbol;         //!< \see Element::SYMBOL_PROPERTY
+	const char * name;           //!< \see Element::NAME_PROPERTY
+	int          nucleons;       //!< \see Element::NUCLEONS_PROPERTY
+	int          electrons;      //!< \see Element::ELECTRONS_PROPERTY
+	double       atomicMass;     //!< \see Element::ATOMIC_MASS_PROPERTY
+	double       abundance;      //!< \see Element::ABUNDANCE_PROPERTY
+	double       nslCoherent[2];   //!< \see Element::NS_L_COHERENT_PROPERTY
+	double       nslIncoherent[2]; //!< \see Element::NS_L_INCOHERENT_PROPERTY
+	double       nsCsCoherent;   //!< \see Element::NS_CS_COHERENT_PROPERTY
+	double       nsCsIncoherent; //!< \see Element::NS_CS_INCOHERENT_PROPERTY
+	double       nsCsTotal;      //!< \see Element::NS_CS_TOTAL_PROPERTY
+	double       nsCsAbsorption; //!< \see Element::NS_CS_ABSORPTION_PROPERTY
+	/// X-Ray scattering factors, sorted by energy, see XraySpan.
+	const double * xrayEnergy;
+	const double * xrayFp;       //!< \f$ f'(E) \f$ for each energy.
+	const double * xrayFpp;      //!< \f$ f''(E) \f$ for each energy.
+	int          xrayCount;      //!< Number of X-Ray triples.
+	/// Properties with data, bit (1 << Element::Property) for each.
+	unsigned int present;
+};
+
+/**
+ * Element data compiled into the program as static, constant tables.
+ *
+ * The C++ source defining the tables is generated at build time from the
+ * XML element data files by \e qsldcalc-datacompiler (see write()). The
+ * tables are initialized statically and live in read-only memory, no
+ * data file has to be opened, read or parsed at startup. The elements
+ * refer to the X-Ray scattering factors in the tables without copying
+ * them.
+ *
+ * The database itself is still built at startup by read(): each record
+ * becomes an Element object with its row in the ElementTable, which
+ * allocates the strings and property values. Only the file access and
+ * parsing is saved, not these allocations. The X-Ray interpolation
+ * coefficients are computed on first access of an element's factors,
+ * see Element::xrayCoefficients().
+ *
+ * Enabled by the CMake option \e STATIC_ELEMENT_TABLE, which defines the
+ * macro of the same name. The generated source defines
+ * staticElementRecords and staticElementRecordCount.
+ */
+class StaticElementTable
+{
+public:
+	/// List of plain pointers to new elements, owned by the caller.
+	typedef XmlParser::ElementPtrList ElementPtrList;
+public:
+	StaticElementTable();  //!< Default constructor.
+	~StaticElementTable(); //!< Destructor.
+
+	/// Creates elements from static element records.
+	/// \param[in] records First record of the table.
+	/// \param[in] count Number of records.
+	/// \returns A list of all new elements. Invalid records are skipped.
+	const ElementPtrList& read(const StaticElementRecord * records,
+	                           int count);
+
+	/// Writes all elements of a database as C++ source file which
+	/// defines the static tables described above. The elements are
+	/// written in the order of their symbols to produce identical
+	/// sources from identical data.
+	/// \param[in] filename Filename of the source to create.
+	/// \param[in] db Database to write.
+	/// \returns True on success, false otherwise.
+	static bool write(const QString& filename, const ElementDatabase& db);
+private:
+	/// Creates a single element from a record.
+	/// \returns A new element or NULL if the record is invalid.
+	static Element * readElement(const StaticElementRecord& rec);
+private:
+	/// All Element Objects created by the current read() call.
+	ElementPtrList mResultList;
+};
+
+#endif
+
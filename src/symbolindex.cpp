@@ -0,0 +1,170 @@
+/*
+ * src/symbolindex.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "symbolindex.h"
+
+/// Number of seeds tried for a single bucket before the number of
+/// buckets is increased.
+static const unsigned int MAX_DISPLACEMENT = 1u << 16;
+
+SymbolIndex::SymbolIndex()
+	: mKeyOffsets(1, 0)
+{
+}
+
+unsigned int 
+SymbolIndex::hash(const char * symbol, int length, unsigned int seed)
+{
+	unsigned int h = 2166136261u ^ (seed * 0x9e3779b9u);
+	for (int i = 0; i < length; i++) {
+		h ^= (unsigned char)symbol[i];
+		h *= 16777619u;
+	}
+	// final mixing, the keys are short and similar
+	h ^= h >> 15;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	return h;
+}
+
+/// Orders buckets by decreasing number of keys.
+static bool 
+largerBucket(const std::vector<int>& a, const std::vector<int>& b)
+{
+	return a.size() > b.size();
+}
+
+bool 
+SymbolIndex::place(const std::vector<std::string>& keys, int bucketCount)
+{
+	const unsigned int slotCount = keys.size();
+	std::vector<std::vector<int> > buckets(bucketCount);
+	for (size_t i = 0; i < keys.size(); i++) {
+		const std::string& k = keys[i];
+		unsigned int b = hash(k.data(), int(k.size()), 0) % bucketCount;
+		buckets[b].push_back(int(i));
+	}
+	for (int b = 0; b < bucketCount; b++) {
+		// remember the bucket number in front of its keys
+		buckets[b].insert(buckets[b].begin(), b);
+	}
+	std::stable_sort(buckets.begin(), buckets.end(), largerBucket);
+
+	mDisplacements.assign(bucketCount, 0);
+	std::vector<int> slotKeys(slotCount, -1);
+	std::vector<unsigned int> slots;
+	for (int b = 0; b < bucketCount; b++)
+	{
+		const std::vector<int>& bucket = buckets[b];
+		if (bucket.size() < 2) break; // the remaining ones are empty
+		unsigned int d = 1;
+		for (; d < MAX_DISPLACEMENT; d++)
+		{
+			slots.clear();
+			size_t i = 1;
+			for (; i < bucket.size(); i++) {
+				const std::string& k = keys[bucket[i]];
+				unsigned int s = hash(k.data(), int(k.size()), d) % slotCount;
+				if (slotKeys[s] >= 0 || 
+				    std::find(slots.begin(), slots.end(), s) != slots.end())
+				{
+					break;
+				}
+				slots.push_back(s);
+			}
+			if (i == bucket.size()) break;
+		}
+		if (d == MAX_DISPLACEMENT) return false;
+		for (size_t i = 1; i < bucket.size(); i++) {
+			slotKeys[slots[i-1]] = bucket[i];
+		}
+		mDisplacements[bucket[0]] = d;
+	}
+
+	mKeyOffsets.assign(1, 0);
+	mKeyData.clear();
+	for (unsigned int s = 0; s < slotCount; s++) {
+		const std::string& k = keys[slotKeys[s]];
+		mKeyData.insert(mKeyData.end(), k.begin(), k.end());
+		mKeyOffsets.push_back(int(mKeyData.size()));
+	}
+	return true;
+}
+
+bool 
+SymbolIndex::build(const std::vector<std::string>& keys)
+{
+	mDisplacements.clear();
+	mKeyOffsets.assign(1, 0);
+	mKeyData.clear();
+	if (keys.empty()) return true;
+
+	std::vector<std::string> sorted(keys);
+	std::sort(sorted.begin(), sorted.end());
+	if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+		return false;
+	}
+	// about four keys per bucket, more buckets if that fails
+	int bucketCount = int(keys.size() / 4) + 1;
+	while (!place(keys, bucketCount)) {
+		bucketCount *= 2;
+	}
+	return true;
+}
+
+int 
+SymbolIndex::size() const
+{
+	return int(mKeyOffsets.size()) - 1;
+}
+
+int 
+SymbolIndex::find(const char * symbol, int length) const
+{
+	if (mDisplacements.empty()) return -1;
+	unsigned int b = hash(symbol, length, 0) % mDisplacements.size();
+	unsigned int s = hash(symbol, length, mDisplacements[b]) % size();
+	int begin = mKeyOffsets[s];
+	if (mKeyOffsets[s+1] - begin != length ||
+	    (length > 0 && std::memcmp(&mKeyData[begin], symbol, length) != 0))
+	{
+		return -1;
+	}
+	return int(s);
+}
+
+int 
+SymbolIndex::find(const std::string& symbol) const
+{
+	return find(symbol.data(), int(symbol.size()));
+}
+
+std::string 
+SymbolIndex::key(int index) const
+{
+	int begin = mKeyOffsets[index];
+	return std::string(mKeyData.begin() + begin, 
+	                   mKeyData.begin() + mKeyOffsets[index+1]);
+}
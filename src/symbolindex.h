@@ -0,0 +1,97 @@
+/*
+ * src/symbolindex.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYMBOL_INDEX_H
+#define SYMBOL_INDEX_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Maps a fixed set of symbols to dense indices 0 ... size()-1 by a 
+ * minimal perfect hash. It is built once from all keys when they are 
+ * known, lookups do not allocate memory and cost two hash calculations 
+ * of the symbol and a single comparison.
+ *
+ * The hash function is constructed by hash and displace: The keys are
+ * distributed to buckets by a first hash. Starting with the largest
+ * bucket, a displacement is searched for each bucket which maps all of
+ * its keys to free slots by a second hash seeded with it. A lookup
+ * calculates the bucket of a symbol, its slot from the displacement of
+ * the bucket and compares the symbol with the key stored in that slot.
+ *
+ * It is immutable after build(), lookups may run in several threads.
+ */
+class SymbolIndex
+{
+public:
+	/// Creates an empty index, find() fails for all symbols.
+	SymbolIndex();
+
+	/// Constructs the perfect hash function for the given keys. 
+	/// Replaces the previous content.
+	/// \param[in] keys Distinct symbols to index, the order does not
+	///            matter.
+	/// \returns False if \e keys contains duplicates, the index is
+	///          empty then.
+	bool build(const std::vector<std::string>& keys);
+
+	/// Returns the number of indexed symbols.
+	int size() const;
+
+	/// Retrieves the index of a symbol.
+	/// \param[in] symbol First character of the symbol, it does not
+	///            need to be null terminated.
+	/// \param[in] length Number of characters of \e symbol.
+	/// \returns A number in the range 0 ... size()-1 or -1, if the
+	///          symbol is not indexed.
+	int find(const char * symbol, int length) const;
+
+	/// Retrieves the index of a symbol, see find(const char*, int).
+	int find(const std::string& symbol) const;
+
+	/// Returns the symbol stored at the specified index.
+	std::string key(int index) const;
+private:
+	/// Calculates the 32 bit FNV-1a hash of a symbol.
+	/// \param[in] seed Modifies the initial value.
+	static unsigned int hash(const char * symbol, int length, 
+	                         unsigned int seed);
+
+	/// Searches displacements for all buckets.
+	/// \param[in] keys Symbols to place.
+	/// \param[in] bucketCount Number of buckets to distribute them to.
+	/// \returns False if no displacement was found for a bucket within
+	///          a bounded number of attempts.
+	bool place(const std::vector<std::string>& keys, int bucketCount);
+private:
+	/// Seed of the second hash for each bucket.
+	std::vector<unsigned int> mDisplacements;
+	/// Start of the key of each slot in mKeyData, followed by the end
+	/// of the last key.
+	std::vector<int>          mKeyOffsets;
+	/// Characters of all keys, ordered by slot.
+	std::vector<char>         mKeyData;
+};
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * src/tests/check.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Minimal checks for the test programs: each test is a plain program 
+// which reports failed checks on stderr and exits with a non-zero status
+// for ctest.
+
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+/// Number of failed checks of the test program.
+static int checkFailures = 0;
+
+/// Reports a failed check, see CHECK().
+inline void 
+reportCheck(bool ok, const char * expr, const char * file, int line)
+{
+	if (ok) return;
+	fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+	checkFailures++;
+}
+
+/// Tests if two values differ by a tolerance at most, relative to 
+/// their magnitude if it is above 1.
+inline bool 
+isClose(double a, double b, double tolerance)
+{
+	return std::fabs(a - b) <= 
+	       tolerance * std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+}
+
+/// Returns the exit status of the test program, reports the number of
+/// failed checks.
+inline int 
+checkResult()
+{
+	if (checkFailures > 0) {
+		fprintf(stderr, "%d checks failed\n", checkFailures);
+	}
+	return checkFailures > 0 ? 1 : 0;
+}
+
+/// Checks that an expression is true.
+#define CHECK(expr) reportCheck((expr), #expr, __FILE__, __LINE__)
+
+/// Checks that two values agree within a relative tolerance.
+#define CHECK_CLOSE(a, b, tolerance) \
+	reportCheck(isClose((a), (b), (tolerance)), #a " == " #b, \
+	            __FILE__, __LINE__)
+
+#endif
@@ -0,0 +1,140 @@
+/*
+ * src/tests/deuterationtest.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the contrast variation of DeuterationSeries: the curves, the 
+// match point and the matching deuteration level. If the element data 
+// directory is given, it also checks that water with all of its 
+// hydrogens exchanged matches the solvent at any fraction of D2O.
+
+#include <vector>
+#include <QString>
+#include "deuterationseries.h"
+#include "elementdatabase.h"
+#include "inputdata.h"
+#include "utils.h"
+#include "check.h"
+
+int main(int argc, char * argv[])
+{
+	// SLDs in 1/cm^2, roughly those of a protein in H2O and D2O
+	DeuterationSeries series;
+	series.setCompound(complex(1.8e10, 1e6), complex(1.5e10, 0.0), 
+	                   complex(3e10, 0.0));
+	series.setSolvent(complex(-0.56e10, 0.0), complex(6.36e10, 0.0));
+
+	// the match point solves sld(x) = solventSld(x)
+	double x = -1.0;
+	CHECK(series.matchPoint(x));
+	CHECK(x > 0.0 && x < 1.0);
+	CHECK_CLOSE(series.sld(x).real(), series.solventSld(x).real(), 1e-12);
+	CHECK_CLOSE(x, (1.8 + 0.56) / (6.36 + 0.56 - 1.5), 1e-12);
+
+	// deuteration moves it to more D2O, exchanging less to less D2O
+	series.setDeuteration(0.5);
+	double deuterated = -1.0;
+	CHECK(series.matchPoint(deuterated));
+	CHECK(deuterated > x);
+	CHECK_CLOSE(series.sld(deuterated).real(), 
+	            series.solventSld(deuterated).real(), 1e-12);
+	series.setDeuteration(0.0);
+	series.setExchangeEfficiency(0.5);
+	double exchanged = -1.0;
+	CHECK(series.matchPoint(exchanged));
+	CHECK(exchanged < x);
+
+	// the level which matches a solvent moves the match point there
+	double level = -1.0;
+	CHECK(series.matchDeuteration(0.8, level));
+	series.setDeuteration(level);
+	CHECK(series.matchPoint(x));
+	CHECK_CLOSE(x, 0.8, 1e-12);
+
+	// the curves over many fractions are linear
+	std::vector<double> d2o;
+	for (int i = 0; i <= 20; i++) d2o.push_back(0.05 * i);
+	series.calculate(&d2o[0], int(d2o.size()));
+	CHECK(series.size() == int(d2o.size()));
+	for (int i = 0; i < series.size(); i++) {
+		CHECK_CLOSE(series.sldReal()[i], series.sld(d2o[i]).real(), 1e-12);
+		CHECK_CLOSE(series.sldImag()[i], series.sld(d2o[i]).imag(), 1e-12);
+		CHECK_CLOSE(series.solventSld()[i], 
+		            series.solventSld(d2o[i]).real(), 1e-12);
+		CHECK_CLOSE(series.contrast()[i], 
+		            series.sldReal()[i] - series.solventSld()[i], 1e-12);
+	}
+	// the contrast changes its sign at the match point only
+	for (int i = 1; i < series.size(); i++) {
+		bool crossed = (series.contrast()[i-1] > 0.0) != 
+		               (series.contrast()[i] > 0.0);
+		CHECK(crossed == (d2o[i-1] < 0.8 && d2o[i] >= 0.8));
+	}
+	series.calculate(0, 0);
+	CHECK(series.size() == 0);
+
+	// no match if the contrast does not depend on the solvent, no 
+	// level without deuterable hydrogens
+	DeuterationSeries parallel;
+	parallel.setCompound(complex(1e10, 0.0), complex(6.92e10, 0.0), 
+	                     complex(0.0, 0.0));
+	parallel.setSolvent(complex(-0.56e10, 0.0), complex(6.36e10, 0.0));
+	CHECK(!parallel.matchPoint(x));
+	CHECK(!parallel.matchDeuteration(0.5, level));
+
+	if (argc > 1)
+	{
+		ElementDatabase db;
+		db.addFromDirectory(QString::fromLocal8Bit(argv[1]));
+		CHECK(db.begin() != db.end());
+		InputData data(db);
+		CalcResult r;
+		r.density = waterDensity();
+		r.xrayEnergy = 8048.0;
+		r.neutronWavelength = 0.6;
+
+		// water exchanging all of its hydrogens is the solvent itself,
+		// the molecular volumes of H2O and D2O differ by 0.4 %
+		DeuterationSeries water;
+		CHECK(data.calcDeuteration(QByteArray("H2O"), 2.0, 0.0, r, water));
+		CHECK_CLOSE(water.sld(0.0).real(), r.sldCoherent.real(), 1e-12);
+		CHECK_CLOSE(water.sld(0.0).real(), 
+		            water.solventSld(0.0).real(), 1e-3);
+		CHECK_CLOSE(water.sld(1.0).real(), 
+		            water.solventSld(1.0).real(), 6e-3);
+		CHECK_CLOSE(water.solventSld(0.0).real(), -0.56e10, 0.02);
+		CHECK_CLOSE(water.solventSld(1.0).real(), 6.36e10, 0.02);
+
+		// deuterating is the same as exchanging in pure D2O
+		DeuterationSeries glucose, deuterable;
+		r.density = 1.54;
+		CHECK(data.calcDeuteration(QByteArray("C6H12O6"), 5.0, 0.0, 
+		                           r, glucose));
+		CHECK(data.calcDeuteration(QByteArray("C6H12O6"), 0.0, 5.0, 
+		                           r, deuterable));
+		deuterable.setDeuteration(1.0);
+		CHECK_CLOSE(glucose.sld(1.0).real(), deuterable.sld(0.0).real(), 
+		            1e-12);
+		CHECK(!data.calcDeuteration(QByteArray("C6H12O6"), 8.0, 5.0, 
+		                            r, glucose));
+	}
+	return checkResult();
+}
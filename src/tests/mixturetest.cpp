@@ -0,0 +1,148 @@
+/*
+ * src/tests/mixturetest.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the fractions and properties of a Mixture of H2O and D2O for 
+// amounts given in each unit, and the rejection of components without
+// density or molar mass.
+
+#include <cmath>
+#include "mixture.h"
+#include "utils.h"
+#include "check.h"
+
+namespace {
+
+/// Creates a component from the totals of a compound.
+CalcResult 
+makeCompound(double density, double molarMass, double sld, 
+             double incoherent, double total, double absorption,
+             bool xray)
+{
+	CalcResult r;
+	r.density = density;
+	r.mass = molarMass;
+	r.sldCoherent = complex(sld, 0.0);
+	r.sldXray = complex(9.4e10, -3e7);
+	r.xrayStatus = (xray ? XraySpan::INTERPOLATED : XraySpan::NO_DATA);
+	r.neutronWavelength = 0.6;
+	r.hasCrossSections = true;
+	r.incoherent = incoherent;
+	r.total = total;
+	r.absorption = absorption;
+	return r;
+}
+
+} // namespace
+
+int main()
+{
+	const CalcResult h2o = makeCompound(1.0, 18.0, -0.56e10, 
+	                                    5.4, 5.6, 0.022, true);
+	const CalcResult d2o = makeCompound(1.1, 20.0, 6.36e10, 
+	                                    0.13, 0.5, 0.0001, false);
+
+	// equal volumes
+	Mixture m;
+	CHECK(!m.calculate());
+	CHECK(m.addComponent(h2o) == 0);
+	CHECK(m.addComponent(d2o) == 1);
+	CHECK(!m.calculate());
+	CHECK(m.setAmount(0, 1.0, Mixture::VOLUME));
+	CHECK(m.setAmount(1, 1.0, Mixture::VOLUME));
+	CHECK(m.calculate());
+	CHECK_CLOSE(m.volumeFraction(0), 0.5, 1e-12);
+	CHECK_CLOSE(m.massFraction(0), 1.0 / 2.1, 1e-12);
+	CHECK_CLOSE(m.moleFraction(0), (1.0/18.0) / (1.0/18.0 + 1.1/20.0), 
+	            1e-12);
+	CHECK_CLOSE(m.massFraction(0) + m.massFraction(1), 1.0, 1e-12);
+	CHECK_CLOSE(m.moleFraction(0) + m.moleFraction(1), 1.0, 1e-12);
+	CHECK_CLOSE(m.density(), 1.05, 1e-12);
+	CHECK_CLOSE(m.sldCoherent().real(), 2.9e10, 1e-12);
+	CHECK(!m.hasXray());
+	CHECK(m.hasCrossSections());
+	CHECK_CLOSE(m.incoherent(), 0.5 * (5.4 + 0.13), 1e-12);
+	CHECK_CLOSE(m.incoherentBackground(), 
+	            m.incoherent() / (16.0 * std::atan(1.0)), 1e-12);
+
+	// absorption scales with the wavelength, as in NeutronSweep
+	double scattering = 0.5 * (5.6 - 0.022 + 0.5 - 0.0001);
+	double absorption = 0.5 * (0.022 + 0.0001);
+	CHECK_CLOSE(m.total(0.6), scattering + absorption, 1e-12);
+	CHECK_CLOSE(m.total(1.2), scattering + 2.0 * absorption, 1e-12);
+	CHECK_CLOSE(m.transmission(0.6, 0.1), 
+	            std::exp(-0.1 * (scattering + absorption)), 1e-12);
+
+	// the same mixture given by mass and by moles
+	Mixture byMass, byMoles;
+	byMass.addComponent(h2o);
+	byMass.addComponent(d2o);
+	byMass.setAmount(0, 1.0, Mixture::MASS);
+	byMass.setAmount(1, 1.1, Mixture::MASS);
+	byMoles.addComponent(h2o);
+	byMoles.addComponent(d2o);
+	byMoles.setAmount(0, 1.0 / 18.0, Mixture::MOLES);
+	byMoles.setAmount(1, 1.1 / 20.0, Mixture::MOLES);
+	CHECK(byMass.calculate() && byMoles.calculate());
+	for (int i = 0; i < 2; i++) {
+		CHECK_CLOSE(byMass.volumeFraction(i), m.volumeFraction(i), 1e-12);
+		CHECK_CLOSE(byMoles.volumeFraction(i), m.volumeFraction(i), 1e-12);
+	}
+	CHECK_CLOSE(byMoles.sldCoherent().real(), m.sldCoherent().real(), 
+	            1e-12);
+
+	// a single component is the pure compound
+	byMass.setAmount(1, 0.0);
+	CHECK(byMass.calculate());
+	CHECK(byMass.volumeFraction(1) == 0.0 && byMass.massFraction(1) == 0.0);
+	CHECK_CLOSE(byMass.density(), 1.0, 1e-12);
+	CHECK_CLOSE(byMass.sldCoherent().real(), -0.56e10, 1e-12);
+	CHECK(byMass.hasXray());
+	CHECK_CLOSE(byMass.sldXray().real(), 9.4e10, 1e-12);
+
+	// a component without density has no volume, without molar mass 
+	// no moles: it may not have an amount
+	CalcResult unknown = makeCompound(0.0, 30.0, 1e10, 0.0, 0.0, 0.0, true);
+	CHECK(m.addComponent(unknown) == 2);
+	CHECK(!m.setAmount(2, 1.0, Mixture::VOLUME));
+	CHECK(m.calculate());
+	CHECK(m.setAmount(2, 1.0, Mixture::MASS));
+	CHECK(!m.calculate());
+	CHECK(m.density() == 0.0);
+	CHECK(m.setAmount(2, 0.0, Mixture::MASS));
+	CHECK(m.calculate());
+	CHECK_CLOSE(m.density(), 1.05, 1e-12);
+	CalcResult massless = makeCompound(1.0, 0.0, 1e10, 0.0, 0.0, 0.0, true);
+	CHECK(m.addComponent(massless) == 3);
+	CHECK(!m.setAmount(3, 1.0, Mixture::MOLES));
+	CHECK(m.setAmount(3, 1.0, Mixture::MASS));
+	CHECK(!m.calculate());
+
+	// invalid amounts and indices are ignored
+	CHECK(!m.setAmount(0, -1.0));
+	CHECK(!m.setAmount(4, 1.0));
+	CHECK(m.massFraction(4) == 0.0);
+	m.clear();
+	CHECK(m.size() == 0);
+
+	return checkResult();
+}
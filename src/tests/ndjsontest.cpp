@@ -0,0 +1,133 @@
+/*
+ * src/tests/ndjsontest.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Serves requests by NdjsonServer and checks which are rejected: the
+// strict JSON number grammar, malformed requests and the order of the
+// answers. Requires the element data directory as argument.
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <QString>
+#include "elementdatabase.h"
+#include "ndjsonserver.h"
+#include "check.h"
+
+namespace {
+
+/// A request line and whether it is valid.
+struct Request
+{
+	const char * json;  //!< Members following the id.
+	bool         valid; //!< Expected to be calculated.
+};
+
+const Request REQUESTS[] = {
+	// numbers as by RFC 8259
+	{ "\"formula\": \"H2O\", \"density\": 1", true },
+	{ "\"formula\": \"H2O\", \"density\": 1.5", true },
+	{ "\"formula\": \"H2O\", \"density\": 0.25", true },
+	{ "\"formula\": \"H2O\", \"density\": -0", true },
+	{ "\"formula\": \"H2O\", \"density\": 1e0", true },
+	{ "\"formula\": \"H2O\", \"density\": 1E+1", true },
+	{ "\"formula\": \"H2O\", \"density\": 2.5e-1", true },
+	{ "\"formula\": \"H2O\", \"energy\":8.048,\"wavelength\" :0.6", true },
+	{ "\"formula\": \"H2O\", \"density\": 01", false },
+	{ "\"formula\": \"H2O\", \"density\": 1.", false },
+	{ "\"formula\": \"H2O\", \"density\": .5", false },
+	{ "\"formula\": \"H2O\", \"density\": +1", false },
+	{ "\"formula\": \"H2O\", \"density\": 1e", false },
+	{ "\"formula\": \"H2O\", \"density\": 1e+", false },
+	{ "\"formula\": \"H2O\", \"density\": -", false },
+	{ "\"formula\": \"H2O\", \"density\": 0x10", false },
+	{ "\"formula\": \"H2O\", \"density\": NaN", false },
+	{ "\"formula\": \"H2O\", \"density\": Infinity", false },
+	{ "\"formula\": \"H2O\", \"density\": 1e999", false },
+	{ "\"formula\": \"H2O\", \"density\": \"1\"", false },
+	// ignored members have to be valid as well
+	{ "\"formula\": \"H2O\", \"note\": \"x\", \"n\": -1.5e3", true },
+	{ "\"formula\": \"H2O\", \"n\": 00", false },
+	{ "\"formula\": \"H2O\", \"n\": [1]", false },
+	// malformed requests
+	{ "\"density\": 1", false },
+	{ "\"formula\": \"H2O\"} {", false },
+	{ "\"formula\": \"H2O\",", false },
+	{ "\"formula\": H2O", false },
+};
+const int REQUEST_COUNT = sizeof(REQUESTS) / sizeof(REQUESTS[0]);
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+	if (argc < 2) {
+		fprintf(stderr, "USAGE: %s <element data directory>\n", argv[0]);
+		return 2;
+	}
+	ElementDatabase db;
+	db.addFromDirectory(QString::fromLocal8Bit(argv[1]));
+	CHECK(db.begin() != db.end());
+
+	std::ostringstream requests;
+	int invalid = 0;
+	for (int i = 0; i < REQUEST_COUNT; i++) {
+		requests << "{\"id\": " << i << ", " << REQUESTS[i].json << "}\n";
+		if (!REQUESTS[i].valid) invalid++;
+	}
+	std::istringstream in(requests.str());
+
+	BatchInput defaults;
+	defaults.density = 1.0;
+	defaults.xrayEnergy = 8.048;
+	defaults.neutronWavelength = 0.6;
+	NdjsonServer server(db, defaults);
+	server.setThreadCount(2);
+	server.setQueueSize(4);
+	FILE * out = tmpfile();
+	CHECK(out != 0);
+	if (!out) return checkResult();
+	CHECK(server.run(in, out) == invalid);
+
+	// one answer per request, in the same order
+	rewind(out);
+	char line[4096];
+	int count = 0;
+	while (fgets(line, sizeof(line), out)) 
+	{
+		int id = -1;
+		CHECK(sscanf(line, "{\"id\": %d,", &id) == 1);
+		CHECK(id == count);
+		if (id < 0 || id >= REQUEST_COUNT) break;
+		bool ok = (strstr(line, "\"status\": \"ok\"") != 0);
+		if (ok != REQUESTS[id].valid) {
+			fprintf(stderr, "request %d: %s", id, line);
+			checkFailures++;
+		}
+		count++;
+	}
+	CHECK(count == REQUEST_COUNT);
+	fclose(out);
+	return checkResult();
+}
@@ -0,0 +1,143 @@
+/*
+ * src/tests/neutronsweeptest.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the cross sections and transmissions of NeutronSweep for water
+// and, if the element data directory is given, compares them with the
+// values InputData::evaluate() calculates at a single wavelength.
+
+#include <cmath>
+#include <vector>
+#include <QString>
+#include "neutronsweep.h"
+#include "elementdatabase.h"
+#include "inputdata.h"
+#include "compiledcompound.h"
+#include "utils.h"
+#include "check.h"
+
+namespace {
+
+/// Compares a sweep with a compound of the database at each wavelength.
+void 
+compareCompound(const ElementDatabase& db, const char * formula,
+                double density, const std::vector<double>& wavelengths)
+{
+	InputData data(db);
+	CompiledCompound compound;
+	data.compile(QByteArray(formula), compound);
+	CalcResult r;
+	r.density = density;
+	r.xrayEnergy = 8048.0;
+	r.neutronWavelength = wavelengths[0];
+	data.evaluate(compound, r);
+
+	NeutronSweep sweep;
+	std::vector<double> thickness(1, 0.1), spectrum;
+	CHECK(data.calcNeutronSweep(compound, r, wavelengths, thickness, 
+	                            spectrum, sweep));
+	int mismatches = 0;
+	for (int i = 0; i < sweep.wavelengthCount(); i++)
+	{
+		r.neutronWavelength = wavelengths[i];
+		data.evaluate(compound, r);
+		if (!r.hasCrossSections ||
+		    !isClose(sweep.absorption()[i], r.absorption, 1e-9) ||
+		    !isClose(sweep.incoherent(), r.incoherent, 1e-9) ||
+		    !isClose(sweep.total()[i], r.total, 1e-9) ||
+		    !isClose(sweep.transmission()[i], r.transmission, 1e-9))
+		{
+			fprintf(stderr, "%s at %g nm differs\n", formula, wavelengths[i]);
+			mismatches++;
+		}
+	}
+	CHECK(mismatches == 0);
+}
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+	// H2O from bound cross sections in barn, 3.34e22 molecules/cm^3
+	NeutronSweep water;
+	water.addElement(2.0, 80.26, 82.02, 0.3326);
+	water.addElement(1.0, 0.0008, 4.232, 0.00019);
+	water.setNumberDensity(3.34e22);
+	CHECK_CLOSE(water.incoherent(), 3.34e-2 * (2.0 * 80.26 + 0.0008), 1e-12);
+	CHECK_CLOSE(water.scattering(), 3.34e-2 * (2.0 * 82.02 + 4.232), 1e-12);
+
+	const double lambda0 = neutronReferenceWavelength();
+	const double absorption0 = 3.34e-2 * (2.0 * 0.3326 + 0.00019);
+	double wavelengths[] = { 0.0, lambda0, 2.0 * lambda0, 1.0 };
+	double thicknesses[] = { 0.0, 0.1, 0.2, 1.0 };
+	CHECK(water.calculate(wavelengths, 4, thicknesses, 4));
+	CHECK(water.wavelengthCount() == 4 && water.thicknessCount() == 4);
+	CHECK(water.absorption()[0] == 0.0);
+	CHECK_CLOSE(water.absorption()[1], absorption0, 1e-12);
+	CHECK_CLOSE(water.absorption()[2], 2.0 * absorption0, 1e-12);
+	for (int i = 0; i < 4; i++) 
+	{
+		const double * row = water.transmission() + 4 * i;
+		CHECK_CLOSE(water.total()[i], 
+		            water.scattering() + water.absorption()[i], 1e-12);
+		CHECK(row[0] == 1.0);
+		for (int j = 1; j < 4; j++) {
+			CHECK_CLOSE(row[j], 
+			            std::exp(-water.total()[i] * thicknesses[j]), 1e-12);
+			CHECK(row[j] < row[j-1]);
+		}
+		// absorption increases with the wavelength
+		if (i > 0) CHECK(row[3] < water.transmission()[4*(i-1) + 3]);
+	}
+
+	// equal weights average all rows, a single weight selects a row
+	for (int j = 0; j < 4; j++) {
+		double sum = 0.0;
+		for (int i = 0; i < 4; i++) sum += water.transmission()[4*i + j];
+		CHECK_CLOSE(water.weightedTransmission()[j], sum / 4.0, 1e-12);
+	}
+	double spectrum[] = { 0.0, 0.0, 2.5, 0.0 };
+	CHECK(water.calculate(wavelengths, 4, thicknesses, 4, spectrum));
+	for (int j = 0; j < 4; j++) {
+		CHECK_CLOSE(water.weightedTransmission()[j], 
+		            water.transmission()[8 + j], 1e-12);
+	}
+
+	// invalid input
+	double negative[] = { 0.5, -0.1 };
+	double none[] = { 0.0, 0.0 };
+	CHECK(!water.calculate(negative, 2, thicknesses, 4));
+	CHECK(!water.calculate(wavelengths, 2, thicknesses, 4, none));
+
+	if (argc > 1)
+	{
+		ElementDatabase db;
+		db.addFromDirectory(QString::fromLocal8Bit(argv[1]));
+		CHECK(db.begin() != db.end());
+		std::vector<double> wl;
+		for (double w = 0.05; w < 2.0; w += 0.01) wl.push_back(w);
+		compareCompound(db, "H2O", 1.0, wl);
+		compareCompound(db, "B4C", 2.52, wl);
+		compareCompound(db, "Gd2O3", 7.41, wl);
+	}
+	return checkResult();
+}
@@ -0,0 +1,217 @@
+/*
+ * src/tests/resultcachetest.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the keys of ResultCache, the invalidation by the database 
+// revision, the memory bound and the cache file: its header, a round 
+// trip of all values and the rejection of foreign or damaged files.
+
+#include <cstring>
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include "resultcache.h"
+#include "check.h"
+
+namespace {
+
+/// Creates a result in which every value differs.
+CalcResult 
+makeResult(double density)
+{
+	CalcResult r;
+	r.density = density;
+	r.xrayEnergy = 8048.0;
+	r.neutronWavelength = 0.6;
+	for (int i = 0; i < 2; i++) {
+		CalcResult::Partial p;
+		p.name = (i == 0 ? "2H" : "O");
+		p.electrons = 1.0 + i;
+		p.mass = 2.0 + i;
+		p.massRatio = 3.0 + i;
+		p.volume = 4.0 + i;
+		p.nslCoherent = complex(5.0 + i, -5.0);
+		p.nslIncoherent = complex(6.0 + i, -6.0);
+		p.sldCoherent = complex(7.0 + i, -7.0);
+		p.sldIncoherent = complex(8.0 + i, -8.0);
+		p.hasXray = (i == 1);
+		p.fp = 9.0 + i;
+		p.fpp = 10.0 + i;
+		p.sldXray = complex(11.0 + i, -11.0);
+		r.partials.push_back(p);
+	}
+	r.electrons = 10.0;
+	r.mass = 20.0;
+	r.volume = 0.03;
+	r.nslCoherent = complex(19.1, -0.1);
+	r.nslIncoherent = complex(2.5, -0.2);
+	r.sldCoherent = complex(6.3e10, -1e6);
+	r.sldIncoherent = complex(1.2e10, -2e6);
+	r.hasCrossSections = true;
+	r.absorption = 0.004;
+	r.incoherent = 0.14;
+	r.total = 0.45;
+	r.transmission = 0.956;
+	r.xrayStatus = XraySpan::INTERPOLATED;
+	r.fp = 0.05;
+	r.fpp = 0.03;
+	r.sldXray = complex(9.4e10, -3e8);
+	return r;
+}
+
+bool 
+samePartial(const CalcResult::Partial& a, const CalcResult::Partial& b)
+{
+	return a.name == b.name && a.electrons == b.electrons && 
+	       a.mass == b.mass && a.massRatio == b.massRatio && 
+	       a.volume == b.volume && a.nslCoherent == b.nslCoherent && 
+	       a.nslIncoherent == b.nslIncoherent && 
+	       a.sldCoherent == b.sldCoherent && 
+	       a.sldIncoherent == b.sldIncoherent && 
+	       a.hasXray == b.hasXray && a.fp == b.fp && a.fpp == b.fpp && 
+	       a.sldXray == b.sldXray;
+}
+
+bool 
+sameResult(const CalcResult& a, const CalcResult& b)
+{
+	if (a.partials.size() != b.partials.size()) return false;
+	for (size_t i = 0; i < a.partials.size(); i++) {
+		if (!samePartial(a.partials[i], b.partials[i])) return false;
+	}
+	return a.density == b.density && a.xrayEnergy == b.xrayEnergy &&
+	       a.neutronWavelength == b.neutronWavelength &&
+	       a.electrons == b.electrons && a.mass == b.mass && 
+	       a.volume == b.volume && a.nslCoherent == b.nslCoherent && 
+	       a.nslIncoherent == b.nslIncoherent && 
+	       a.sldCoherent == b.sldCoherent && 
+	       a.sldIncoherent == b.sldIncoherent &&
+	       a.hasCrossSections == b.hasCrossSections && 
+	       a.absorption == b.absorption && a.incoherent == b.incoherent &&
+	       a.total == b.total && a.transmission == b.transmission &&
+	       a.xrayStatus == b.xrayStatus && a.fp == b.fp && 
+	       a.fpp == b.fpp && a.sldXray == b.sldXray;
+}
+
+/// Reads a file completely.
+QByteArray 
+readFile(const QString& name)
+{
+	QFile file(name);
+	if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+	return file.readAll();
+}
+
+/// Replaces the content of a file.
+void 
+writeFile(const QString& name, const QByteArray& data)
+{
+	QFile file(name);
+	if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		file.write(data);
+	}
+}
+
+} // namespace
+
+int main()
+{
+	// the formula, a null character and big endian doubles
+	CalcResult inputs;
+	inputs.density = 1.0;
+	inputs.xrayEnergy = -2.0;
+	inputs.neutronWavelength = 0.0;
+	QByteArray key = ResultCache::makeKey("H2 O1", inputs);
+	const unsigned char expected[] = { 'H', '2', ' ', 'O', '1', 0,
+		0x3f, 0xf0, 0, 0, 0, 0, 0, 0,
+		0xc0, 0x00, 0, 0, 0, 0, 0, 0,
+		0x00, 0x00, 0, 0, 0, 0, 0, 0 };
+	CHECK(key.size() == int(sizeof(expected)));
+	CHECK(key.size() == int(sizeof(expected)) && 
+	      memcmp(key.constData(), expected, sizeof(expected)) == 0);
+	inputs.neutronWavelength = 0.6;
+	CHECK(ResultCache::makeKey("H2 O1", inputs) != key);
+	CHECK(ResultCache::makeKey("H2 O1 ", inputs) != 
+	      ResultCache::makeKey("H2 O1", inputs));
+
+	// lookups and the database revision
+	ResultCache cache;
+	CalcResult water = makeResult(1.0), heavy = makeResult(1.1);
+	QByteArray waterKey = ResultCache::makeKey("H2 O1", water);
+	QByteArray heavyKey = ResultCache::makeKey("D2 O1", heavy);
+	CalcResult found;
+	cache.setRevision(1);
+	CHECK(!cache.find(waterKey, found));
+	cache.insert(waterKey, water);
+	cache.insert(heavyKey, heavy);
+	CHECK(cache.size() == 2);
+	CHECK(cache.find(waterKey, found) && sameResult(found, water));
+	CHECK(cache.find(heavyKey, found) && sameResult(found, heavy));
+	cache.setRevision(1);
+	CHECK(cache.size() == 2);
+
+	// the file: header in big endian, then all results
+	const QString filename("resultcachetest.bin");
+	const quint64 fingerprint = Q_UINT64_C(0x0123456789abcdef);
+	CHECK(cache.save(filename, fingerprint));
+	QByteArray file = readFile(filename);
+	const unsigned char header[] = { 'Q', 'S', 'R', 'C', 0, 0, 0, 2,
+		0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0, 0, 0, 2 };
+	CHECK(file.size() > int(sizeof(header)) &&
+	      memcmp(file.constData(), header, sizeof(header)) == 0);
+
+	ResultCache restored;
+	CHECK(restored.load(filename, fingerprint));
+	CHECK(restored.size() == 2);
+	CHECK(restored.find(waterKey, found) && sameResult(found, water));
+	CHECK(restored.find(heavyKey, found) && sameResult(found, heavy));
+
+	// other element data, a damaged or a missing file add nothing
+	ResultCache rejected;
+	CHECK(!rejected.load(filename, fingerprint + 1));
+	writeFile(filename, file.left(file.size() - 1));
+	CHECK(!rejected.load(filename, fingerprint));
+	QByteArray version(file);
+	version[7] = char(99);
+	writeFile(filename, version);
+	CHECK(!rejected.load(filename, fingerprint));
+	QFile::remove(filename);
+	CHECK(!rejected.load(filename, fingerprint));
+	CHECK(rejected.size() == 0);
+
+	// results of a previous revision are dropped
+	cache.setRevision(2);
+	CHECK(cache.size() == 0);
+	CHECK(!cache.find(waterKey, found));
+
+	// the least recently used results are dropped beyond the bound
+	ResultCache small(4 * int(sizeof(CalcResult)));
+	for (int i = 0; i < 20; i++) {
+		CalcResult r = makeResult(1.0 + i);
+		small.insert(ResultCache::makeKey("H2 O1", r), r);
+	}
+	CHECK(small.size() > 0 && small.size() < 20);
+	CalcResult last = makeResult(20.0);
+	CHECK(small.find(ResultCache::makeKey("H2 O1", last), found));
+
+	return checkResult();
+}
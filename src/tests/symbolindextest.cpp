@@ -0,0 +1,142 @@
+/*
+ * src/tests/symbolindextest.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks that SymbolIndex maps each key of a set of element symbols and
+// isotopes to its own index and rejects all other symbols. If the
+// element data directory is given, the keys of the database are used
+// as well and each element is looked up by the characters of its key.
+
+#include <set>
+#include <string>
+#include <vector>
+#include <QByteArray>
+#include <QString>
+#include "symbolindex.h"
+#include "elementdatabase.h"
+#include "check.h"
+
+namespace {
+
+const char * const SYMBOLS[] = {
+	"H", "He", "Li", "Be", "B", "C", "N", "O", "F", "Ne", "Na", "Mg", 
+	"Al", "Si", "P", "S", "Cl", "Ar", "K", "Ca", "Sc", "Ti", "V", "Cr", 
+	"Mn", "Fe", "Co", "Ni", "Cu", "Zn", "Ga", "Ge", "As", "Se", "Br", 
+	"Kr", "Rb", "Sr", "Y", "Zr", "Nb", "Mo", "Tc", "Ru", "Rh", "Pd", 
+	"Ag", "Cd", "In", "Sn", "Sb", "Te", "I", "Xe", "Cs", "Ba", "Gd", 
+	"Pt", "Au", "Hg", "Pb", "U"
+};
+const int SYMBOL_COUNT = sizeof(SYMBOLS) / sizeof(SYMBOLS[0]);
+
+/// Checks that all keys are found at distinct indices, by their own
+/// characters and within a longer buffer.
+void 
+checkKeys(const SymbolIndex& index, const std::vector<std::string>& keys)
+{
+	CHECK(index.size() == int(keys.size()));
+	std::set<int> indices;
+	int mismatches = 0;
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		const std::string& k = keys[i];
+		int n = index.find(k);
+		std::string padded = k + "12";
+		if (n < 0 || n >= index.size() || index.key(n) != k ||
+		    index.find(padded.data(), int(k.size())) != n ||
+		    index.find(padded) >= 0) 
+		{
+			fprintf(stderr, "key '%s' not indexed\n", k.c_str());
+			mismatches++;
+		}
+		indices.insert(n);
+	}
+	CHECK(mismatches == 0);
+	CHECK(indices.size() == keys.size());
+}
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+	// symbols and some isotopes with the nucleon number in front
+	std::vector<std::string> keys;
+	for (int i = 0; i < SYMBOL_COUNT; i++) {
+		keys.push_back(SYMBOLS[i]);
+		for (int nucleons = 2*i + 1; nucleons < 2*i + 6; nucleons++) {
+			char name[16];
+			sprintf(name, "%d%s", nucleons, SYMBOLS[i]);
+			keys.push_back(name);
+		}
+	}
+	SymbolIndex index;
+	CHECK(index.find("H") == -1);
+	CHECK(index.build(keys));
+	checkKeys(index, keys);
+
+	// similar symbols which are not keys
+	const char * const others[] = { "", "h", "HE", "Hx", "X", "1", "H1", 
+		"0H", "1000U", "Uu", "Gd ", " Gd" };
+	for (int i = 0; i < int(sizeof(others) / sizeof(others[0])); i++) {
+		CHECK(index.find(others[i]) == -1);
+	}
+	CHECK(index.find(0, 0) == -1);
+
+	// duplicates are rejected and leave an empty index
+	std::vector<std::string> duplicates(keys);
+	duplicates.push_back("Fe");
+	CHECK(!index.build(duplicates));
+	CHECK(index.size() == 0);
+	CHECK(index.find("Fe") == -1);
+
+	// small sets, rebuilding replaces the keys
+	std::vector<std::string> single(1, "D");
+	CHECK(index.build(single));
+	checkKeys(index, single);
+	CHECK(index.find("H") == -1);
+	CHECK(index.build(std::vector<std::string>()));
+	CHECK(index.size() == 0 && index.find("D") == -1);
+
+	if (argc > 1)
+	{
+		ElementDatabase db;
+		db.addFromDirectory(QString::fromLocal8Bit(argv[1]));
+		std::vector<std::string> dbKeys;
+		int lookups = 0;
+		for (ElementDatabase::Iterator it = db.begin(); it != db.end(); ++it)
+		{
+			QByteArray k = it.key().toLatin1();
+			dbKeys.push_back(std::string(k.constData(), k.size()));
+			Element::ConstPtr e = db.getElement(k.constData(), k.size());
+			if (!e || e != db.getElement(it.key())) {
+				fprintf(stderr, "element '%s' not found\n", k.constData());
+			} else {
+				lookups++;
+			}
+		}
+		CHECK(dbKeys.size() > 100);
+		CHECK(lookups == int(dbKeys.size()));
+		CHECK(!db.getElement("Xx", 2));
+		CHECK(index.build(dbKeys));
+		checkKeys(index, dbKeys);
+	}
+	return checkResult();
+}
@@ -0,0 +1,169 @@
+/*
+ * src/tests/xraycubictest.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the cubic interpolation of X-Ray scattering factors by 
+// XrayCubic: detection of absorption edges, values at the tabulated 
+// energies, monotonicity between them and linear intervals at edges.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "xraytable.h"
+#include "check.h"
+
+namespace {
+
+/// Evaluates a cubic with coefficients \e c and value \e y at t = 0.
+double 
+evaluate(const double * c, double y, double t)
+{
+	return y + t * (c[0] + t * (c[1] + t * c[2]));
+}
+
+/// Checks that each interval of a factor starts and ends at the 
+/// tabulated values and stays between them.
+/// \returns The number of intervals which do not.
+int 
+checkIntervals(const XrayCubic& cubic, const double * values, int size, 
+               bool realPart)
+{
+	int failures = 0;
+	for (int k = 0; k + 1 < size; k++)
+	{
+		const double * c = realPart ? cubic.fp(k) : cubic.fpp(k);
+		const double lo = std::min(values[k], values[k+1]);
+		const double hi = std::max(values[k], values[k+1]);
+		const double tol = 1e-12 * std::max(1.0, hi - lo);
+		bool ok = isClose(evaluate(c, values[k], 1.0), values[k+1], 1e-12);
+		for (int i = 1; i < 100; i++) {
+			double y = evaluate(c, values[k], i / 100.0);
+			if (y < lo - tol || y > hi + tol) ok = false;
+		}
+		if (!ok) {
+			fprintf(stderr, "interval %d of %s overshoots\n", k, 
+			        realPart ? "f'" : "f''");
+			failures++;
+		}
+	}
+	return failures;
+}
+
+} // namespace
+
+int main()
+{
+	// f'' decreasing like 1/E^2 with an edge between the energies 5 and
+	// 6 and a rise too small for an edge between 8 and 9, f' with a 
+	// local maximum and a minimum
+	const int n = 12;
+	const double energy[n] = { 
+		100.0, 120.0, 150.0, 155.0, 200.0, 260.0, 
+		261.0, 300.0, 400.0, 410.0, 600.0, 1000.0 };
+	double fp[n], fpp[n];
+	for (int i = 0; i < n; i++) {
+		fpp[i] = 1e5 / (energy[i] * energy[i]);
+		fp[i] = std::sin(energy[i] / 100.0);
+	}
+	for (int i = 6; i < n; i++) fpp[i] *= 4.0;
+	fpp[9] = fpp[8] * (1.0 + 0.5 * XrayCubic::EDGE_RISE);
+
+	XraySpan span(energy, fp, fpp, n);
+	XrayCubic cubic;
+	cubic.build(span);
+	CHECK(cubic.size() == n - 1);
+	CHECK(cubic.edges().size() == 1 && cubic.edges()[0] == 5);
+	CHECK(checkIntervals(cubic, fp, n, true) == 0);
+	CHECK(checkIntervals(cubic, fpp, n, false) == 0);
+
+	// the edge interval is linear in both factors
+	CHECK(cubic.fp(5)[1] == 0.0 && cubic.fp(5)[2] == 0.0);
+	CHECK(cubic.fpp(5)[1] == 0.0 && cubic.fpp(5)[2] == 0.0);
+	span.setCubic(&cubic);
+	double f1, f2;
+	CHECK(span.interpolate(260.5, f1, f2) == XraySpan::INTERPOLATED);
+	CHECK(isClose(f1, 0.5 * (fp[5] + fp[6]), 1e-12));
+	CHECK(isClose(f2, 0.5 * (fpp[5] + fpp[6]), 1e-12));
+
+	// tabulated energies give the tabulated values, close to them the 
+	// interpolation is continuous
+	int mismatches = 0;
+	for (int i = 0; i < n; i++) {
+		double below1, below2, above1, above2;
+		if (span.interpolate(energy[i], f1, f2) != XraySpan::EXACT ||
+		    f1 != fp[i] || f2 != fpp[i]) mismatches++;
+		if (i > 0) {
+			span.interpolate(energy[i] * (1.0 - 1e-12), below1, below2);
+			if (!isClose(below1, fp[i], 1e-9) || 
+			    !isClose(below2, fpp[i], 1e-9)) mismatches++;
+		}
+		if (i + 1 < n) {
+			span.interpolate(energy[i] * (1.0 + 1e-12), above1, above2);
+			if (!isClose(above1, fp[i], 1e-9) || 
+			    !isClose(above2, fpp[i], 1e-9)) mismatches++;
+		}
+	}
+	CHECK(mismatches == 0);
+	CHECK(span.interpolate(50.0, f1, f2) == XraySpan::BELOW_RANGE);
+	CHECK(span.interpolate(2000.0, f1, f2) == XraySpan::ABOVE_RANGE);
+
+	// monotone data gives a monotone interpolation
+	int reversals = 0;
+	double previous = 0.0;
+	for (double e = energy[6]; e <= energy[n-1]; e += 0.5) {
+		span.interpolate(e, f1, f2);
+		if (e > energy[6] && f2 > previous && 
+		    (e < energy[8] || e > energy[9])) reversals++;
+		previous = f2;
+	}
+	CHECK(reversals == 0);
+
+	// linear data is reproduced exactly
+	double line[n];
+	for (int i = 0; i < n; i++) line[i] = 3.0 - 0.002 * energy[i];
+	XraySpan linearSpan(energy, line, line, n);
+	XrayCubic linear;
+	linear.build(linearSpan);
+	CHECK(linear.edges().empty());
+	linearSpan.setCubic(&linear);
+	mismatches = 0;
+	for (double e = energy[0]; e < energy[n-1]; e += 3.7) {
+		linearSpan.interpolate(e, f1, f2);
+		if (!isClose(f1, 3.0 - 0.002 * e, 1e-12)) mismatches++;
+	}
+	CHECK(mismatches == 0);
+
+	// a single interval is linear, fewer factors give no coefficients
+	XrayCubic pair;
+	pair.build(XraySpan(energy, fp, fpp, 2));
+	CHECK(pair.size() == 1 && pair.edges().empty());
+	CHECK(isClose(pair.fp(0)[0], fp[1] - fp[0], 1e-12));
+	CHECK(pair.fp(0)[1] == 0.0 && pair.fp(0)[2] == 0.0);
+	pair.build(XraySpan(energy, fp, fpp, 1));
+	CHECK(pair.empty() && pair.size() == 0);
+	pair.build(XraySpan());
+	CHECK(pair.empty() && pair.edges().empty());
+	cubic.clear();
+	CHECK(cubic.empty() && cubic.edges().empty());
+
+	return checkResult();
+}
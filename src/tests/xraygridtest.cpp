@@ -0,0 +1,135 @@
+/*
+ * src/tests/xraygridtest.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks XrayGrid::lowerBound() against a binary search on grids with
+// and without uniform segments, and the sharing of grids by XrayGridPool.
+
+#include <algorithm>
+#include <vector>
+#include "xraytable.h"
+#include "check.h"
+
+namespace {
+
+/// Compares XrayGrid::lowerBound() with std::lower_bound() at all 
+/// energies, next to them, midway between them and beyond both ends.
+/// \returns The number of energies with a different result.
+int 
+compareLowerBound(const std::vector<double>& energies)
+{
+	const double * e = &energies[0];
+	const int n = int(energies.size());
+	XrayGrid grid(e, n);
+	std::vector<double> probes;
+	probes.push_back(e[0] - 1.0);
+	probes.push_back(e[n-1] + 1.0);
+	for (int i = 0; i < n; i++) {
+		probes.push_back(e[i]);
+		probes.push_back(e[i] * (1.0 - 1e-15));
+		probes.push_back(e[i] * (1.0 + 1e-15));
+		if (i+1 < n) probes.push_back(0.5 * (e[i] + e[i+1]));
+	}
+	int mismatches = 0;
+	for (size_t i = 0; i < probes.size(); i++) {
+		int expected = int(std::lower_bound(e, e + n, probes[i]) - e);
+		if (grid.lowerBound(probes[i]) != expected) {
+			fprintf(stderr, "lowerBound(%.17g) != %d\n", probes[i], expected);
+			mismatches++;
+		}
+	}
+	return mismatches;
+}
+
+/// Appends \e count energies starting at \e start with a constant step.
+void 
+appendUniform(std::vector<double>& energies, double start, double step, 
+              int count)
+{
+	for (int i = 0; i < count; i++) energies.push_back(start + i * step);
+}
+
+} // namespace
+
+int main()
+{
+	// a single segment, its step is not exactly representable
+	std::vector<double> uniform;
+	appendUniform(uniform, 10.0, 0.1, 500);
+	CHECK(compareLowerBound(uniform) == 0);
+
+	// segments separated by irregular energies, the last run is too 
+	// short for a segment
+	std::vector<double> mixed;
+	appendUniform(mixed, 1.0, 1.0, 50);
+	mixed.push_back(50.5);
+	mixed.push_back(51.7);
+	mixed.push_back(53.0);
+	appendUniform(mixed, 60.0, 2.5, 40);
+	appendUniform(mixed, 170.0, 10.0, 3);
+	mixed.push_back(200.0);
+	appendUniform(mixed, 300.0, 0.3, 100);
+	CHECK(compareLowerBound(mixed) == 0);
+
+	// logarithmic, like the tabulated scattering factors: no segments
+	std::vector<double> logarithmic;
+	for (int i = 0; i < 500; i++) {
+		logarithmic.push_back(10.0 * std::pow(1.02, i));
+	}
+	CHECK(compareLowerBound(logarithmic) == 0);
+
+	// fewer energies than a segment
+	std::vector<double> tiny;
+	appendUniform(tiny, 1.0, 1.0, 2);
+	CHECK(compareLowerBound(tiny) == 0);
+
+	// interpolation over a shared grid equals that over plain arrays
+	std::vector<double> fp(mixed.size()), fpp(mixed.size());
+	for (size_t i = 0; i < mixed.size(); i++) {
+		fp[i] = std::sin(0.1 * i);
+		fpp[i] = 1.0 / (1.0 + i);
+	}
+	XrayGrid grid(&mixed[0], int(mixed.size()));
+	XraySpan plain(&mixed[0], &fp[0], &fpp[0], int(mixed.size()));
+	XraySpan shared(&grid, &fp[0], &fpp[0]);
+	for (double energy = 0.5; energy < 340.0; energy += 0.37) {
+		double fp1, fpp1, fp2, fpp2;
+		XraySpan::Status s1 = plain.interpolate(energy, fp1, fpp1);
+		XraySpan::Status s2 = shared.interpolate(energy, fp2, fpp2);
+		CHECK(s1 == s2 && fp1 == fp2 && fpp1 == fpp2);
+	}
+
+	// identical grids are stored once
+	XrayGridPool pool;
+	std::vector<double> copy(uniform);
+	const XrayGrid * a = pool.intern(&uniform[0], int(uniform.size()), true);
+	const XrayGrid * b = pool.intern(&copy[0], int(copy.size()), true);
+	const XrayGrid * c = pool.intern(&mixed[0], int(mixed.size()), true);
+	CHECK(a == b);
+	CHECK(a != c);
+	CHECK(pool.size() == 2);
+	copy.assign(copy.size(), 0.0);
+	CHECK(a->size() == int(uniform.size()));
+	CHECK(a->energies()[1] == uniform[1]);
+
+	return checkResult();
+}
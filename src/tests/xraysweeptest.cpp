@@ -0,0 +1,181 @@
+/*
+ * src/tests/xraysweeptest.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks that XraySweep calculates the same scattering factors and SLD
+// as the interpolation at single energies: for synthetic tables and, if
+// the element data directory is given, for compounds of the database 
+// compared with InputData::evaluate().
+
+#include <cmath>
+#include <vector>
+#include <QString>
+#include "xraysweep.h"
+#include "elementdatabase.h"
+#include "inputdata.h"
+#include "compiledcompound.h"
+#include "utils.h"
+#include "check.h"
+
+namespace {
+
+/// Scattering factors of a synthetic element.
+struct Table
+{
+	std::vector<double> energy, fp, fpp;
+
+	/// Tabulates smooth factors with an absorption edge at \e edge.
+	Table(double first, double last, int count, double edge) {
+		for (int i = 0; i < count; i++) {
+			double e = first + (last - first) * i / (count - 1);
+			energy.push_back(e);
+			fp.push_back(-2.0 * std::exp(-std::fabs(e - edge) / 20.0));
+			fpp.push_back((e < edge ? 1.0 : 4.0) * 100.0 / e);
+		}
+	}
+	XraySpan span() const { 
+		return XraySpan(&energy[0], &fp[0], &fpp[0], int(energy.size()));
+	}
+};
+
+/// Compares a sweep with the compound of the specified database at each
+/// energy, like InputData::calcXrayEnergies() calculates it.
+void 
+compareCompound(const ElementDatabase& db, const char * formula,
+                const std::vector<double>& energies)
+{
+	InputData data(db);
+	CompiledCompound compound;
+	data.compile(QByteArray(formula), compound);
+	CalcResult r;
+	r.density = 1.0;
+	r.neutronWavelength = 0.6;
+	r.xrayEnergy = energies[0];
+	data.evaluate(compound, r);
+
+	XraySweep sweep;
+	CHECK(data.calcXraySweep(compound, r, energies, sweep));
+	CHECK(sweep.rangeBegin() < sweep.rangeEnd());
+	int mismatches = 0;
+	for (int i = 0; i < sweep.size(); i++)
+	{
+		r.xrayEnergy = energies[i];
+		data.evaluate(compound, r);
+		bool inRange = (i >= sweep.rangeBegin() && i < sweep.rangeEnd());
+		bool same = (r.hasXray() == inRange);
+		if (same && inRange) {
+			same = isClose(sweep.fp()[i], r.fp, 1e-9) &&
+			       isClose(sweep.fpp()[i], r.fpp, 1e-9) &&
+			       isClose(sweep.sldReal()[i], r.sldXray.real(), 1e-9) &&
+			       isClose(sweep.sldImag()[i], r.sldXray.imag(), 1e-9);
+		}
+		if (!same) {
+			fprintf(stderr, "%s at %g eV differs\n", formula, energies[i]);
+			mismatches++;
+		}
+	}
+	CHECK(mismatches == 0);
+}
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+	// two elements with tables of different ranges, one interpolated 
+	// by cubic polynomials
+	Table a(10.0, 100.0, 91, 55.5), b(20.0, 200.0, 61, 150.0);
+	XraySpan spanA = a.span(), spanB = b.span();
+	XrayCubic cubic;
+	cubic.build(spanA);
+	CHECK(cubic.edges().size() == 1);
+	spanA.setCubic(&cubic);
+
+	std::vector<double> energies;
+	for (double e = 5.0; e < 250.0; e += 0.7) energies.push_back(e);
+	const int n = int(energies.size());
+
+	XraySweep sweep;
+	sweep.addElement(spanA, 2.0);
+	sweep.addElement(spanB, 3.0);
+	sweep.setElectrons(50.0);
+	sweep.setVolume(1e-22);
+	CHECK(sweep.calculate(&energies[0], n));
+	CHECK(sweep.size() == n);
+	for (int i = 0; i < n; i++)
+	{
+		double fpA, fppA, fpB, fppB;
+		XraySpan::Status sA = spanA.interpolate(energies[i], fpA, fppA);
+		XraySpan::Status sB = spanB.interpolate(energies[i], fpB, fppB);
+		bool covered = (sA == XraySpan::EXACT || 
+		                sA == XraySpan::INTERPOLATED) &&
+		               (sB == XraySpan::EXACT || 
+		                sB == XraySpan::INTERPOLATED);
+		bool inRange = (i >= sweep.rangeBegin() && i < sweep.rangeEnd());
+		CHECK(covered == inRange);
+		if (!inRange) {
+			CHECK(sweep.fp()[i] == 0.0 && sweep.sldReal()[i] == 0.0);
+			continue;
+		}
+		double fp = 2.0 * fpA + 3.0 * fpB;
+		double fpp = 2.0 * fppA + 3.0 * fppB;
+		double scale = electronRadius() / 1e-22;
+		double base = 50.0 - std::pow(50.0/82.5, 2.37);
+		CHECK_CLOSE(sweep.fp()[i], fp, 1e-12);
+		CHECK_CLOSE(sweep.fpp()[i], fpp, 1e-12);
+		CHECK_CLOSE(sweep.sldReal()[i], (base + fp) * scale, 1e-12);
+		CHECK_CLOSE(sweep.sldImag()[i], fpp * scale, 1e-12);
+	}
+
+	// an element with a single factor does not contribute
+	double single[] = { 1.0 };
+	XraySweep partial;
+	partial.addElement(spanB, 1.0);
+	partial.addElement(XraySpan(single, single, single, 1), 1.0);
+	partial.setVolume(1e-22);
+	CHECK(partial.calculate(&energies[0], n));
+	CHECK(energies[partial.rangeBegin()] >= 20.0);
+	CHECK(energies[partial.rangeEnd()-1] <= 200.0);
+
+	// invalid input and no elements give an empty range
+	std::vector<double> unsorted(energies.rbegin(), energies.rend());
+	CHECK(!sweep.calculate(&unsorted[0], n));
+	CHECK(sweep.rangeBegin() == sweep.rangeEnd());
+	XraySweep empty;
+	empty.setVolume(0.0);
+	CHECK(!empty.calculate(&energies[0], n));
+	empty.setVolume(1e-22);
+	CHECK(empty.calculate(&energies[0], n));
+	CHECK(empty.rangeBegin() == empty.rangeEnd());
+
+	if (argc > 1)
+	{
+		ElementDatabase db;
+		db.addFromDirectory(QString::fromLocal8Bit(argv[1]));
+		CHECK(db.begin() != db.end());
+		std::vector<double> xray;
+		for (double e = 10.0; e < 40000.0; e *= 1.003) xray.push_back(e);
+		const char * formulas[] = { "H2O", "Fe2O3", "CuSO4", "C8H8", 
+		                            "Gd2O3", "UO2" };
+		for (int i = 0; i < 6; i++) compareCompound(db, formulas[i], xray);
+	}
+	return checkResult();
+}
@@ -33,3 +33,18 @@ double electronRadius(void)
 	return 2.8179402894;
 }
 
+double neutronReferenceWavelength(void)
+{
+	return 0.17982;
+}
+
+double waterDensity(void)
+{
+	return 0.99705;
+}
+
+double heavyWaterDensity(void)
+{
+	return 1.1044;
+}
+
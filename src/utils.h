@@ -32,5 +32,15 @@ double avogadro(void);
 /// (femto meter, \f$ 10^{-15} m \f$)
 double electronRadius(void);
 
+/// Wavelength of neutrons with a velocity of 2200 m/s in nm, the
+/// reference for absorption cross sections
+double neutronReferenceWavelength(void);
+
+/// Density of \f$ H_2O \f$ at 25 \f$ ^\circ C \f$ in \f$ g/cm^3 \f$
+double waterDensity(void);
+
+/// Density of \f$ D_2O \f$ at 25 \f$ ^\circ C \f$ in \f$ g/cm^3 \f$
+double heavyWaterDensity(void);
+
 #endif // this file
 
@@ -21,15 +21,372 @@
  * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
 #include <QFile>
+#include <QResource>
 #include "xmlparser.h"
 
 #define DBG 0
 #define STD(a) (a).toAscii().data()
 #define STDR(a) STD((a).toString())
 
-XmlParser::XmlParser()
-	: mHandlers(11, &XmlParser::handleNoToken)
+/// Read-only view of a character sequence within the raw data of a file.
+/// Used by the fast parser instead of copies of the data.
+struct CharRange
+{
+	const char * begin; //!< First character.
+	const char * end;   //!< Behind the last character.
+
+	CharRange(): begin(NULL), end(NULL) {}
+	CharRange(const char * b, const char * e): begin(b), end(e) {}
+
+	bool isEmpty() const { return begin == end; }
+
+	/// Compares with a null-terminated character string.
+	bool operator==(const char * str) const
+	{
+		const char * c = begin;
+		for(; c != end && *str; c++, str++) {
+			if (*c != *str) return false;
+		}
+		return c == end && *str == '\0';
+	}
+	bool operator!=(const char * str) const { return !operator==(str); }
+};
+
+/// Locale-independent conversion of a decimal number to an integer.
+/// Like QString::toInt(), it results in 0 for invalid numbers.
+static int toInt(const CharRange& r)
+{
+	const char * c = r.begin;
+	if (c == r.end) return 0;
+	bool neg = (*c == '-');
+	if (*c == '-' || *c == '+') c++;
+	if (c == r.end || r.end - c > 9) return 0;
+	int val = 0;
+	for(; c != r.end; c++) {
+		if (*c < '0' || *c > '9') return 0;
+		val = val * 10 + (*c - '0');
+	}
+	return neg ? -val : val;
+}
+
+/// Locale-independent conversion of a decimal floating point number.
+/// Exactly representable mantissas with small exponents (virtually all
+/// values in the data files) are converted without rounding error by a
+/// single multiplication or division. Other numbers are left to
+/// QByteArray::toDouble(). Like QString::toDouble(), it results in 0.0
+/// for invalid numbers.
+static double toDouble(const CharRange& r)
+{
+	static const double pow10[] = {
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,
+		1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+		1e20, 1e21, 1e22
+	};
+	const quint64 maxExact = Q_UINT64_C(9007199254740992); // 2^53
+	if (r.isEmpty()) return 0.0;
+
+	const char * c = r.begin;
+	bool neg = (*c == '-');
+	if (*c == '-' || *c == '+') c++;
+	quint64 mantissa = 0;
+	int digits = 0, exponent = 0;
+	bool exact = true, anyDigit = false;
+	for(; c != r.end && *c >= '0' && *c <= '9'; c++) {
+		anyDigit = true;
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*c - '0');
+			if (mantissa > 0) digits++;
+		} else {
+			exponent++;
+			if (*c != '0') exact = false;
+		}
+	}
+	if (c != r.end && *c == '.') {
+		for(c++; c != r.end && *c >= '0' && *c <= '9'; c++) {
+			anyDigit = true;
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*c - '0');
+				if (mantissa > 0) digits++;
+				exponent--;
+			} else if (*c != '0') {
+				exact = false;
+			}
+		}
+	}
+	if (!anyDigit) return 0.0;
+	if (c != r.end && (*c == 'e' || *c == 'E')) {
+		c++;
+		bool negExp = (c != r.end && *c == '-');
+		if (c != r.end && (*c == '-' || *c == '+')) c++;
+		if (c == r.end) return 0.0;
+		int exp = 0;
+		for(; c != r.end && *c >= '0' && *c <= '9'; c++) {
+			if (exp < 10000) exp = exp * 10 + (*c - '0');
+		}
+		exponent += negExp ? -exp : exp;
+	}
+	if (c != r.end) return 0.0;
+
+	if (exact && mantissa <= maxExact && exponent >= -22 && exponent <= 22)
+	{
+		double val = double(mantissa);
+		if (exponent < 0) val /= pow10[-exponent];
+		else              val *= pow10[exponent];
+		return neg ? -val : val;
+	}
+	// rare case, allocates
+	return QByteArray(r.begin, int(r.end - r.begin)).toDouble();
+}
+
+/**
+ * Minimal XML tokenizer for the fast path of XmlParser. Supports the
+ * subset of XML used by the element data files: XML declaration,
+ * DOCTYPE without internal subset, comments, elements with attributes
+ * and whitespace between them. Everything else, e.g. entity references,
+ * character data or non-ASCII characters, is reported as error.
+ */
+class FastXmlScanner
+{
+public:
+	/// Token types returned by next().
+	typedef enum {
+		START_ELEMENT, //!< A start tag, possibly an empty element.
+		END_ELEMENT,   //!< An end tag.
+		END_OF_DATA,   //!< All data was processed.
+		ERROR_TOKEN    //!< Unsupported or invalid data.
+	} TokenType;
+
+	FastXmlScanner(const char * begin, const char * end)
+		: mPos(begin), mEnd(end), mEmpty(false), mAttrCount(0)
+	{}
+
+	/// Reads the next tag.
+	TokenType next();
+
+	/// Name of the recent element.
+	const CharRange& name() const { return mName; }
+
+	/// True, if the recent start tag is an empty element (\e "<a/>").
+	bool isEmptyElement() const { return mEmpty; }
+
+	/// Value of the attribute of the recent start tag. Empty if there is
+	/// no such attribute.
+	CharRange attribute(const char * name) const
+	{
+		for(int i=0; i < mAttrCount; i++) {
+			if (mAttrNames[i] == name) return mAttrValues[i];
+		}
+		return CharRange();
+	}
+
+	/// Current position in the data, behind the recent tag.
+	const char * pos() const { return mPos; }
+
+	/// Moves behind the next occurence of the specified character string.
+	/// \returns False if it was not found.
+	bool skipBehind(const char * str);
+private:
+	/// Tests if the data at the current position starts with \e str.
+	bool startsWith(const char * str) const;
+
+	/// Reads a name of an element or attribute.
+	bool readName(CharRange& name);
+
+	/// Skips whitespace.
+	void skipSpace()
+	{
+		while (mPos != mEnd && (*mPos == ' ' || *mPos == '\t' ||
+		                        *mPos == '\n' || *mPos == '\r')) mPos++;
+	}
+private:
+	/// Maximum number of attributes per element.
+	static const int MAX_ATTRIBUTES = 8;
+
+	const char * mPos;  //!< Current position.
+	const char * mEnd;  //!< End of data.
+	CharRange    mName; //!< Name of the recent element.
+	bool         mEmpty;//!< Recent start tag is an empty element.
+	int          mAttrCount; //!< Number of attributes of the recent element.
+	CharRange    mAttrNames[MAX_ATTRIBUTES];  //!< Attribute names.
+	CharRange    mAttrValues[MAX_ATTRIBUTES]; //!< Attribute values.
+};
+
+bool FastXmlScanner::startsWith(const char * str) const
+{
+	const char * c = mPos;
+	for(; *str; c++, str++) {
+		if (c == mEnd || *c != *str) return false;
+	}
+	return true;
+}
+
+bool FastXmlScanner::skipBehind(const char * str)
+{
+	size_t len = strlen(str);
+	for(; mEnd - mPos >= qint64(len); mPos++) {
+		if (memcmp(mPos, str, len) == 0) {
+			mPos += len;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FastXmlScanner::readName(CharRange& name)
+{
+	name.begin = mPos;
+	while (mPos != mEnd &&
+	       ((*mPos >= 'a' && *mPos <= 'z') || (*mPos >= 'A' && *mPos <= 'Z') ||
+	        (*mPos >= '0' && *mPos <= '9') ||
+	        *mPos == '_' || *mPos == '-' || *mPos == '.' || *mPos == ':'))
+	{
+		mPos++;
+	}
+	name.end = mPos;
+	return !name.isEmpty();
+}
+
+FastXmlScanner::TokenType FastXmlScanner::next()
+{
+	for(;;) {
+		skipSpace();
+		if (mPos == mEnd) return END_OF_DATA;
+		// character data is not supported
+		if (*mPos != '<') return ERROR_TOKEN;
+		mPos++;
+		if (startsWith("?xml")) {
+			// the declaration has to specify the encoding
+			const char * declEnd = mPos;
+			while (declEnd != mEnd && *declEnd != '>') declEnd++;
+			bool utf8 = false;
+			for(; mPos != declEnd; mPos++) {
+				if (startsWith("encoding=\"utf-8\"")) utf8 = true;
+			}
+			if (!utf8 || !skipBehind(">")) return ERROR_TOKEN;
+		} else if (startsWith("!--")) {
+			if (!skipBehind("-->")) return ERROR_TOKEN;
+		} else if (startsWith("!DOCTYPE ")) {
+			mPos += 9;
+			skipSpace();
+			CharRange dtdName;
+			if (!readName(dtdName) || dtdName != "chemical_element_list")
+				return ERROR_TOKEN;
+			// no internal subset
+			while (mPos != mEnd && *mPos != '>' && *mPos != '[') mPos++;
+			if (mPos == mEnd || *mPos != '>') return ERROR_TOKEN;
+			mPos++;
+		} else if (mPos != mEnd && *mPos == '/') {
+			mPos++;
+			if (!readName(mName)) return ERROR_TOKEN;
+			skipSpace();
+			if (mPos == mEnd || *mPos != '>') return ERROR_TOKEN;
+			mPos++;
+			return END_ELEMENT;
+		} else {
+			if (!readName(mName)) return ERROR_TOKEN;
+			mAttrCount = 0;
+			mEmpty = false;
+			for(;;) {
+				skipSpace();
+				if (mPos == mEnd) return ERROR_TOKEN;
+				if (*mPos == '>') {
+					mPos++;
+					return START_ELEMENT;
+				}
+				if (startsWith("/>")) {
+					mPos += 2;
+					mEmpty = true;
+					return START_ELEMENT;
+				}
+				if (mAttrCount >= MAX_ATTRIBUTES ||
+				    !readName(mAttrNames[mAttrCount])) return ERROR_TOKEN;
+				skipSpace();
+				if (mPos == mEnd || *mPos != '=') return ERROR_TOKEN;
+				mPos++;
+				skipSpace();
+				if (mPos == mEnd || (*mPos != '"' && *mPos != '\'')) 
+					return ERROR_TOKEN;
+				char quote = *mPos++;
+				CharRange& value = mAttrValues[mAttrCount];
+				value.begin = mPos;
+				for(; mPos != mEnd && *mPos != quote; mPos++) {
+					// no entities, markup or non-ASCII characters
+					if (*mPos == '&' || *mPos == '<' || 
+					    (static_cast<unsigned char>(*mPos) & 0x80))
+						return ERROR_TOKEN;
+				}
+				if (mPos == mEnd) return ERROR_TOKEN;
+				value.end = mPos++;
+				mAttrCount++;
+			}
+		}
+	}
+}
+
+/// Provides the raw bytes of a file without copying them. Uncompressed
+/// resources (the XML files embedded in the GUI, read if the compiled
+/// image can not be loaded) are accessed in place, regular files (e.g.
+/// qsldcalc-cli --data and the datacompiler) are memory mapped.
+class RawFileData
+{
+public:
+	RawFileData(const QString& filename)
+		: mFile(filename), mMapped(NULL), mData(NULL), mSize(0)
+	{
+		QResource res(filename);
+		if (res.isValid()) {
+			if (!res.isCompressed()) {
+				mData = reinterpret_cast<const char *>(res.data());
+				mSize = res.size();
+			}
+			return;
+		}
+		if (!mFile.open(QIODevice::ReadOnly) || mFile.size() <= 0) return;
+		mMapped = mFile.map(0, mFile.size());
+		if (mMapped) {
+			mData = reinterpret_cast<const char *>(mMapped);
+			mSize = mFile.size();
+		}
+	}
+	~RawFileData() { if (mMapped) mFile.unmap(mMapped); }
+
+	/// The file content, NULL if not available.
+	const char * data() const { return mData; }
+	/// Size of the file content in bytes.
+	qint64 size() const { return mSize; }
+private:
+	QFile        mFile;   //!< The file if it is memory mapped.
+	uchar      * mMapped; //!< Memory mapped file content.
+	const char * mData;   //!< File content.
+	qint64       mSize;   //!< Size of the file content.
+};
+
+/// Reads the \e ev entries of an \e xray_scattering_anomalous_coefficients
+/// section up to its end tag by the fast path.
+/// \returns False, if the data is not in the expected format.
+static bool readFastXrayCoefficients(FastXmlScanner& scan, XrayTable& coefficients)
+{
+	for(;;) {
+		FastXmlScanner::TokenType token = scan.next();
+		if (token == FastXmlScanner::END_ELEMENT) {
+			return scan.name() == "xray_scattering_anomalous_coefficients";
+		}
+		if (token != FastXmlScanner::START_ELEMENT) return false;
+		if (scan.name() != "ev") continue;
+		if (!scan.isEmptyElement()) return false;
+		coefficients.add(toDouble(scan.attribute("val")),
+			toDouble(scan.attribute("fp")),
+			toDouble(scan.attribute("fpp")) );
+	}
+}
+
+XmlParser::XmlParser(bool lazyXray)
+	: mHandlers(11, &XmlParser::handleNoToken),
+	  mElement(NULL),
+	  mLazyXray(lazyXray),
+	  mFastData(NULL)
 {
 	mHandlers.at(QXmlStreamReader::Invalid) = &XmlParser::handleInvalid;
 	mHandlers.at(QXmlStreamReader::StartDocument) = &XmlParser::handleStartDocument;
@@ -78,7 +435,7 @@ void XmlParser::handleStartElement(void)
 			{
 				mCurSection = ELEMENT_CONFIG_SECTION;
 				mElement = new Element();
-				if (!mElement.isNull())
+				if (mElement)
 					mElement->setProperty(
 						Element::SYMBOL_PROPERTY,
 						ATTR(mXml, symbol, StdString)
@@ -86,7 +443,7 @@ void XmlParser::handleStartElement(void)
 			}
 			break;
 		case ELEMENT_CONFIG_SECTION:
-			if (mElement.isNull()) break;
+			if (!mElement) break;
 			if (mXml.name() == "name") {
 				mElement->setProperty(
 					Element::NAME_PROPERTY,
@@ -117,11 +474,14 @@ void XmlParser::handleStartElement(void)
 			} else if (mXml.name() == "neutron_scattering_cross_section") {
 				mCurSection = NS_C_SECTION;
 			} else if (mXml.name() == "xray_scattering_anomalous_coefficients") {
+				// read right away: files which end up here were rejected
+				// by readFast(), their character offsets (e.g. of UTF-8
+				// or entities) are no byte positions to seek to later
 				mCurSection = XRAY_COEFFICIENTS_SECTION;
 			}
 			break;
 		case NS_L_SECTION:
-			if (mElement.isNull()) break;
+			if (!mElement) break;
 			if (mXml.name() == "coherent") 
 			{
 				mElement->setProperty(
@@ -141,7 +501,7 @@ void XmlParser::handleStartElement(void)
 			}
 			break;
 		case NS_C_SECTION:
-			if (mElement.isNull()) break;
+			if (!mElement) break;
 			if (mXml.name() == "coherent") {
 				mElement->setProperty(
 					Element::NS_CS_COHERENT_PROPERTY,
@@ -161,7 +521,7 @@ void XmlParser::handleStartElement(void)
 			}
 			break;
 		case XRAY_COEFFICIENTS_SECTION:
-			if (mElement.isNull()) break;
+			if (!mElement) break;
 			if (mXml.name() == "ev") {
 				mElement->addXrayCoefficient(
 					ATTR(mXml, val, Double),
@@ -216,6 +576,163 @@ void XmlParser::handleDTD(void)
 	}
 }
 
+bool XmlParser::handleFastStartElement(FastXmlScanner& scan)
+{
+	const CharRange& name = scan.name();
+	switch (mCurSection) {
+		case IGNORED_SECTION:
+			if (name == "chemical_element") 
+			{
+				mCurSection = ELEMENT_CONFIG_SECTION;
+				mElement = new Element();
+				CharRange sym(scan.attribute("symbol"));
+				mElement->setProperty(
+					Element::SYMBOL_PROPERTY,
+					std::string(sym.begin, sym.end));
+			}
+			break;
+		case ELEMENT_CONFIG_SECTION:
+			if (!mElement) break;
+			if (name == "name") {
+				CharRange val(scan.attribute("val"));
+				mElement->setProperty(
+					Element::NAME_PROPERTY,
+					std::string(val.begin, val.end));
+			} else if (name == "abundance") {
+				mElement->setProperty(Element::ABUNDANCE_PROPERTY,
+					toDouble(scan.attribute("val")));
+			} else if (name == "atomic_weight") {
+				mElement->setProperty(Element::ATOMIC_MASS_PROPERTY,
+					toDouble(scan.attribute("val")));
+			} else if (name == "nucleons") {
+				mElement->setProperty(Element::NUCLEONS_PROPERTY,
+					toInt(scan.attribute("val")));
+			} else if (name == "electrons") {
+				mElement->setProperty(Element::ELECTRONS_PROPERTY,
+					toInt(scan.attribute("val")));
+			} else if (name == "neutron_scattering_length") {
+				mCurSection = NS_L_SECTION;
+			} else if (name == "neutron_scattering_cross_section") {
+				mCurSection = NS_C_SECTION;
+			} else if (name == "xray_scattering_anomalous_coefficients") {
+				if (scan.isEmptyElement()) break;
+				if (mLazyXray) {
+					// remember the position, read it on demand
+					mElement->setXrayCoefficientsSource(
+						new XmlXrayCoefficientsSource(mFilename,
+							scan.pos() - mFastData));
+					if (!scan.skipBehind("</xray_scattering_anomalous_coefficients>"))
+						return false;
+				} else {
+					XrayTable coefficients;
+					if (!readFastXrayCoefficients(scan, coefficients))
+						return false;
+					XraySpan xray = coefficients.span();
+					for(int i=0; i < xray.size(); i++) {
+						mElement->addXrayCoefficient(xray.energy(i),
+							xray.fp(i), xray.fpp(i));
+					}
+				}
+			}
+			break;
+		case NS_L_SECTION:
+			if (!mElement) break;
+			if (name == "coherent" || name == "incoherent") 
+			{
+				mElement->setProperty(
+					(name == "coherent") ? Element::NS_L_COHERENT_PROPERTY
+					                     : Element::NS_L_INCOHERENT_PROPERTY,
+					complex(
+						toDouble(scan.attribute("re")),
+						toDouble(scan.attribute("im"))
+				));
+			}
+			break;
+		case NS_C_SECTION:
+			if (!mElement) break;
+			if (name == "coherent") {
+				mElement->setProperty(Element::NS_CS_COHERENT_PROPERTY,
+					toDouble(scan.attribute("re"))); 
+			} else if (name == "incoherent") {
+				mElement->setProperty(Element::NS_CS_INCOHERENT_PROPERTY,
+					toDouble(scan.attribute("re")));
+			} else if (name == "total") {
+				mElement->setProperty(Element::NS_CS_TOTAL_PROPERTY,
+					toDouble(scan.attribute("val")));
+			} else if (name == "absorption") {
+				mElement->setProperty(Element::NS_CS_ABSORPTION_PROPERTY,
+					toDouble(scan.attribute("val")));
+			}
+			break;
+		default:
+			break;
+	}
+	return true;
+}
+
+bool XmlParser::handleFastEndElement(const FastXmlScanner& scan)
+{
+	const CharRange& name = scan.name();
+	if (name == "chemical_element") {
+		mCurSection = IGNORED_SECTION;
+		if (!mElement || !mElement->isValid()) return false;
+		mResultList.push_back(mElement);
+		mElement = NULL; // forget about this element now
+	} else
+	if (name == "chemical_element_list" && 
+	    mCurSection != IGNORED_SECTION)
+	{
+		return false;
+	} else
+	if (name == "neutron_scattering_length" ||
+	    name == "neutron_scattering_cross_section")
+	{
+		mCurSection = ELEMENT_CONFIG_SECTION;
+	}
+	return true;
+}
+
+bool XmlParser::readFast(const char * data, qint64 size)
+{
+	FastXmlScanner scan(data, data + size);
+	mFastData = data;
+	mCurSection = IGNORED_SECTION;
+	mResultList.clear();
+	mElement = NULL;
+
+	bool ok = true;
+	for(;;) {
+		FastXmlScanner::TokenType token = scan.next();
+		if (token == FastXmlScanner::END_OF_DATA) {
+			break;
+		} else if (token == FastXmlScanner::START_ELEMENT) {
+			ok = handleFastStartElement(scan);
+			if (ok && scan.isEmptyElement()) 
+				ok = handleFastEndElement(scan);
+		} else if (token == FastXmlScanner::END_ELEMENT) {
+			ok = handleFastEndElement(scan);
+		} else {
+			ok = false;
+		}
+		if (!ok) break;
+	}
+	if (mCurSection != IGNORED_SECTION) ok = false;
+	if (!ok) discardElements();
+	mElement = NULL;
+	mFastData = NULL;
+	return ok;
+}
+
+void XmlParser::discardElements()
+{
+	delete mElement;
+	mElement = NULL;
+	foreach(Element::Ptr ep, mResultList) {
+		delete ep;
+	}
+	mResultList.clear();
+}
+
 const XmlParser::ElementPtrList& XmlParser::read(const QString& filename)
 {
 #ifdef DEBUG
@@ -225,6 +742,14 @@ const XmlParser::ElementPtrList& XmlParser::read(const QString& filename)
 			<< STD(filename) <<")"<< std::endl;
 #endif
 
+	mFilename = filename;
+	{
+		RawFileData raw(filename);
+		if (raw.data() && readFast(raw.data(), raw.size()))
+			return mResultList;
+	}
+
+	// validating reader, slower
 	QFile xmlFile(filename);
 	if ( !xmlFile.open(QIODevice::ReadOnly) ) {
 		mXml.raiseError("Could not open xml file !");
@@ -254,15 +779,68 @@ const XmlParser::ElementPtrList& XmlParser::read(const QString& filename)
 		std::cerr << std::endl;
 #endif
 		// delete dangling memory
-		delete mElement;
-		foreach(Element::Ptr ep, mResultList) {
-			if (!ep.isNull()) delete ep;
-		}
-		mResultList.clear();
+		discardElements();
 	}
 
 	mElement = NULL; // forget the last element created (should be NULL already)
 	return mResultList;
 }
 
+XmlXrayCoefficientsSource::XmlXrayCoefficientsSource(const QString& filename, 
+                                                     qint64 offset)
+	: XrayCoefficientsSource(),
+	  mFilename(filename),
+	  mOffset(offset)
+{
+}
 
+bool XmlXrayCoefficientsSource::load(XrayTable& coefficients) const
+{
+	// the offset counts bytes, recorded by XmlParser::readFast()
+	{
+		RawFileData raw(mFilename);
+		if (raw.data() && mOffset >= 0 && mOffset < raw.size()) {
+			FastXmlScanner scan(raw.data() + mOffset, 
+			                    raw.data() + raw.size());
+			if (readFastXrayCoefficients(scan, coefficients)) 
+				return true;
+			coefficients.clear();
+		}
+	}
+
+	// validating reader, slower
+	QFile xmlFile(mFilename);
+	if ( !xmlFile.open(QIODevice::ReadOnly) || !xmlFile.seek(mOffset) )
+		return false;
+
+	// extract the section only, up to its end tag
+	const char * sectionEnd = "</xray_scattering_anomalous_coefficients>";
+	QByteArray section("<xray_scattering_anomalous_coefficients>");
+	int endPos = -1;
+	while (endPos < 0 && !xmlFile.atEnd()) {
+		section.append(xmlFile.readLine());
+		endPos = section.indexOf(sectionEnd);
+	}
+	if (endPos < 0) return false;
+	section.resize(endPos + int(strlen(sectionEnd)));
+
+	QXmlStreamReader xml(section);
+	while (!xml.atEnd()) {
+		if (xml.readNext() != QXmlStreamReader::StartElement ||
+		    xml.name() != "ev") continue;
+		double energy = ATTR(xml, val, Double);
+		coefficients.add(energy,
+			ATTR(xml, fp, Double),
+			ATTR(xml, fpp, Double) );
+	}
+	if (xml.hasError()) {
+#ifdef DEBUG
+		std::cerr << "XmlXrayCoefficientsSource::load, "
+			<< "A XML parse error occured: '"
+			<< STD(xml.errorString()) << "'" << std::endl;
+#endif
+		coefficients.clear();
+		return false;
+	}
+	return true;
+}
@@ -27,9 +27,18 @@
 #include <QXmlStreamReader>
 #include "element.h"
 
+class FastXmlScanner;
+
 /**
  * Parses real-world element description files.
  *
+ * Files are read by a fast path first which works on the raw bytes of
+ * the file (in place for uncompressed resources, memory mapped
+ * otherwise) without allocating memory per attribute. It handles the
+ * plain subset of XML used by the data files. If it encounters anything
+ * else, the file is read again by \e QXmlStreamReader which does the
+ * validation and error reporting.
+ *
  * \anchor dtd
  * The Document Type Definition for those element data files follows:
  * \include chemical_elements.dtd
@@ -42,10 +51,16 @@ private:
 	/// <em>enum QXmlStreamReader::TokenType</em>. 
 	typedef void (XmlParser::*XmlTokenHandler) (void);
 public:
-	/// List of guarded pointers to database elements.
+	/// List of plain pointers to new elements, owned by the caller.
 	typedef std::list<Element::Ptr> ElementPtrList;
 public:
-	XmlParser();  //!< Default constructor.
+	/// Default constructor.
+	/// \param[in] lazyXray If true, the X-Ray scattering factors are
+	///            not read by read() but on their first access. Applies
+	///            to files accepted by the fast reader only, the others
+	///            are read completely by QXmlStreamReader.
+	///            \sa XmlXrayCoefficientsSource
+	XmlParser(bool lazyXray = true);
 	~XmlParser(); //!< Destructor.
 
 	/// Reads decriptions of elements from file.
@@ -90,6 +105,22 @@ private:
 	/// Handles \e QXmlStreamReader::DTD. Tests the current DTD name and
 	/// raises an error if it is unknown.
 	void handleDTD(void);
+
+	/// Fast path of read(). Parses the raw data of a file.
+	/// \returns False if the data is not in the expected format, no
+	///          element was created then.
+	bool readFast(const char * data, qint64 size);
+
+	/// Fast path equivalent of handleStartElement().
+	/// \returns False if the data is not in the expected format.
+	bool handleFastStartElement(FastXmlScanner& scan);
+
+	/// Fast path equivalent of handleEndElement().
+	/// \returns False if the data is not in the expected format.
+	bool handleFastEndElement(const FastXmlScanner& scan);
+
+	/// Frees all elements created by the current read() call.
+	void discardElements();
 private:
 	/// Descibes the current element configuration state.
 	typedef enum {
@@ -115,9 +146,36 @@ private:
 	/// The last section processed.
 	SectionType                  mCurSection;
 	/// The current Element being configured.
-	Element::Ptr            mElement;
+	Element::Ptr                 mElement;
 	/// All Element Objects created by the current read() call.
 	ElementPtrList               mResultList;
+	/// Defer reading of X-Ray scattering factors.
+	bool                         mLazyXray;
+	/// Name of the file processed by the current read() call.
+	QString                      mFilename;
+	/// Start of the raw data processed by readFast().
+	const char                 * mFastData;
+};
+
+/**
+ * Reads the X-Ray scattering factors of a single element from its XML
+ * data file on demand. Knows the position of the factors within the file
+ * which was recorded by XmlParser at startup.
+ */
+class XmlXrayCoefficientsSource: public XrayCoefficientsSource
+{
+public:
+	/// Constructor.
+	/// \param[in] filename The XML data file to read from.
+	/// \param[in] offset Byte position right behind the start tag of
+	///            the \e xray_scattering_anomalous_coefficients section.
+	XmlXrayCoefficientsSource(const QString& filename, qint64 offset);
+
+	/// Reads all \e ev entries of the section.
+	virtual bool load(XrayTable& coefficients) const;
+private:
+	QString mFilename; //!< The XML data file.
+	qint64  mOffset;   //!< Position of the section within the file.
 };
 
 #endif
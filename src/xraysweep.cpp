@@ -0,0 +1,161 @@
+/*
+ * src/xraysweep.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "utils.h"
+#include "xraysweep.h"
+
+XraySweep::XraySweep()
+	: mElectrons(0.0), mVolume(1.0), mBegin(0), mEnd(0)
+{
+}
+
+void 
+XraySweep::addElement(const XraySpan& coefficients, double weight)
+{
+	if (coefficients.size() < 2) return;
+	Component c;
+	c.coefficients = coefficients;
+	c.weight = weight;
+	mComponents.push_back(c);
+}
+
+bool 
+XraySweep::calculate(const double * energies, int count)
+{
+	mBegin = mEnd = 0;
+	for (int i = 1; i < count; i++) {
+		if (energies[i] < energies[i-1]) return false;
+	}
+	if (mVolume <= 0.0) return false;
+	mFp.assign(count, 0.0);
+	mFpp.assign(count, 0.0);
+	mSldReal.assign(count, 0.0);
+	mSldImag.assign(count, 0.0);
+	mFraction.resize(count);
+	mNodes.resize(NODE_COLUMNS * count);
+	if (mComponents.empty()) return true; // no data at all
+	mBegin = 0;
+	mEnd = count;
+
+	// restrict the range to the energies covered by all elements
+	for (size_t c = 0; c < mComponents.size(); c++) 
+	{
+		const XraySpan& xray = mComponents[c].coefficients;
+		const double * first = std::lower_bound(energies, 
+		                         energies + count, xray.energy(0));
+		const double * last = std::upper_bound(energies, 
+		                         energies + count, xray.energy(xray.size()-1));
+		mBegin = std::max(mBegin, int(first - energies));
+		mEnd = std::min(mEnd, int(last - energies));
+	}
+	if (mBegin >= mEnd) {
+		mBegin = mEnd = 0;
+		return true;
+	}
+
+	for (size_t c = 0; c < mComponents.size(); c++) {
+		accumulate(mComponents[c].coefficients, mComponents[c].weight,
+		           energies, mBegin, mEnd);
+	}
+
+	// X-Ray SLD, see sldXray() in inputdata.cpp
+	double scale = electronRadius() / mVolume;
+	double base = mElectrons - pow(mElectrons/82.5, 2.37);
+	double * re = &mSldReal[0];
+	double * im = &mSldImag[0];
+	const double * fp = &mFp[0];
+	const double * fpp = &mFpp[0];
+	for (int i = mBegin; i < mEnd; i++) {
+		re[i] = (base + fp[i]) * scale;
+		im[i] = fpp[i] * scale;
+	}
+	return true;
+}
+
+void 
+XraySweep::accumulate(const XraySpan& coefficients, double weight,
+                      const double * energies, int begin, int end)
+{
+	const double * en = coefficients.energies();
+	const double * f1 = coefficients.fps();
+	const double * f2 = coefficients.fpps();
+	const XrayCubic * cubic = coefficients.cubic();
+	const int count = size();
+	double * fraction = &mFraction[0];
+	double * p0 = &mNodes[0];
+	double * p1 = p0 + count;
+	double * p2 = p1 + count;
+	double * p3 = p2 + count;
+	double * q0 = p3 + count;
+	double * q1 = q0 + count;
+	double * q2 = q1 + count;
+	double * q3 = q2 + count;
+
+	// merge pass: find the enclosing table interval of each energy,
+	// the energies are known to be within the table, and gather its
+	// values, so the loops below read contiguous arrays only
+	int j = 0;
+	for (int i = begin; i < end; i++) 
+	{
+		while (en[j+1] < energies[i]) j++;
+		fraction[i] = (energies[i] - en[j]) / (en[j+1] - en[j]);
+		p0[i] = f1[j];
+		q0[i] = f2[j];
+		if (cubic) {
+			const double * a = cubic->fp(j);
+			const double * b = cubic->fpp(j);
+			p1[i] = a[0], p2[i] = a[1], p3[i] = a[2];
+			q1[i] = b[0], q2[i] = b[1], q3[i] = b[2];
+		} else {
+			p1[i] = f1[j+1];
+			q1[i] = f2[j+1];
+		}
+	}
+
+	// interpolation, exact at both ends of an interval,
+	// one loop per result keeps the aliasing checks of the
+	// vectorizer within its limit
+	double * fp = &mFp[0];
+	double * fpp = &mFpp[0];
+	if (cubic) {
+		for (int i = begin; i < end; i++) {
+			double t = fraction[i];
+			fp[i] += weight * (p0[i] + t * (p1[i] + t * (p2[i] + t * p3[i])));
+		}
+		for (int i = begin; i < end; i++) {
+			double t = fraction[i];
+			fpp[i] += weight * (q0[i] + t * (q1[i] + t * (q2[i] + t * q3[i])));
+		}
+		return;
+	}
+	for (int i = begin; i < end; i++) {
+		double t = fraction[i];
+		fp[i] += weight * ((1.0 - t) * p0[i] + t * p1[i]);
+	}
+	for (int i = begin; i < end; i++) {
+		double t = fraction[i];
+		fpp[i] += weight * ((1.0 - t) * q0[i] + t * q1[i]);
+	}
+}
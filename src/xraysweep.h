@@ -0,0 +1,128 @@
+/*
+ * src/xraysweep.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EDB_XRAYSWEEP_H
+#define EDB_XRAYSWEEP_H
+
+#include <vector>
+#include "xraytable.h"
+
+/**
+ * Calculates the X-Ray scattering factors \f$ f'(E) \f$, \f$ f''(E) \f$
+ * and the complex X-Ray SLD of a compound for many energies at once.
+ *
+ * The compound is described by the scattering factors of its elements,
+ * each weighted by its coefficient in the formula, see addElement(),
+ * and by its total number of electrons and volume. The energies have to
+ * be sorted, so the table of each element is walked only once,
+ * in parallel to the energies. This scalar merge pass also gathers the
+ * table values of the enclosing interval of each energy into contiguous
+ * arrays. The interpolation and the SLD are then calculated in plain
+ * loops over these arrays without indirect access, which GCC vectorizes
+ * (the build enables -ftree-vectorize for this file, see
+ * src/CMakeLists.txt).
+ *
+ * Results are only valid for energies covered by the tables of all
+ * elements, see rangeBegin() and rangeEnd(). Outside, all values are 0.
+ * The range is empty if no element contributes, like 
+ * XraySpan::NO_DATA of InputData::calcXrayEnergies().
+ */
+class XraySweep
+{
+public:
+	/// Creates an empty compound.
+	XraySweep();
+
+	/// Adds an element of the compound. Elements without at least two
+	/// scattering factors do not contribute, as in 
+	/// InputData::calcXrayEnergies().
+	/// \param[in] coefficients The scattering factors of the element,
+	///            they have to outlive calculate().
+	/// \param[in] weight Coefficient of the element in the formula.
+	void addElement(const XraySpan& coefficients, double weight);
+
+	/// Sets the total number of electrons of the compound.
+	void setElectrons(double electrons) { mElectrons = electrons; }
+
+	/// Sets the molecular volume of the compound in \f$ cm^3 \f$ (scaled
+	/// like in InputData::calcXrayEnergies()).
+	void setVolume(double volume) { mVolume = volume; }
+
+	/// Calculates all values for the specified energies.
+	/// \param[in] energies Energies in eV, sorted in increasing order.
+	/// \param[in] count Number of energies.
+	/// \returns False, if the energies are not sorted or the volume is
+	///          not positive. The range is empty then.
+	bool calculate(const double * energies, int count);
+
+	int size() const { return int(mFp.size()); } //!< Number of energies.
+
+	/// Index of the first energy covered by all elements.
+	int rangeBegin() const { return mBegin; }
+	/// Index behind the last energy covered by all elements.
+	int rangeEnd() const { return mEnd; }
+
+	/// \f$ f'(E) \f$ of the compound for each energy.
+	const double * fp() const { return data(mFp); }
+	/// \f$ f''(E) \f$ of the compound for each energy.
+	const double * fpp() const { return data(mFpp); }
+	/// Real part of the X-Ray SLD in \f$ cm^{-2} \f$ for each energy.
+	const double * sldReal() const { return data(mSldReal); }
+	/// Imaginary part of the X-Ray SLD in \f$ cm^{-2} \f$ for each energy.
+	const double * sldImag() const { return data(mSldImag); }
+private:
+	static const double * data(const std::vector<double>& v) {
+		return v.empty() ? 0 : &v[0];
+	}
+
+	/// Adds the weighted scattering factors of one element for the
+	/// energies [begin, end), which are all covered by its table.
+	/// Uses mFraction and mNodes as scratch space.
+	void accumulate(const XraySpan& coefficients, double weight,
+	                const double * energies, int begin, int end);
+
+	/// An element of the compound.
+	struct Component {
+		XraySpan coefficients; //!< Its scattering factors.
+		double   weight;       //!< Its coefficient in the formula.
+	};
+	std::vector<Component> mComponents; //!< All elements.
+	double                 mElectrons;  //!< Total number of electrons.
+	double                 mVolume;     //!< Molecular volume.
+	int                    mBegin;      //!< See rangeBegin().
+	int                    mEnd;        //!< See rangeEnd().
+	std::vector<double>    mFp;         //!< See fp().
+	std::vector<double>    mFpp;        //!< See fpp().
+	std::vector<double>    mSldReal;    //!< See sldReal().
+	std::vector<double>    mSldImag;    //!< See sldImag().
+	std::vector<double>    mFraction;   //!< Interpolation fraction per energy.
+	/// Table values of the interval of each energy, NODE_COLUMNS
+	/// columns of size() values each.
+	std::vector<double>    mNodes;
+	/// Number of columns of mNodes: \f$ f' \f$ and \f$ f'' \f$ at the
+	/// start of the interval followed by three values each, the end
+	/// of the interval or the cubic coefficients.
+	enum { NODE_COLUMNS = 8 };
+};
+
+#endif
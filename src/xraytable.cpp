@@ -0,0 +1,321 @@
+/*
+ * src/xraytable.cpp
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <QByteArray>
+#include <QHash>
+#include "xraytable.h"
+
+XrayGrid::XrayGrid(const double * energies, int size)
+	: mEnergy(energies), mSize(size)
+{
+	int i = 0;
+	while (i + MIN_SEGMENT_SIZE <= mSize)
+	{
+		// extend a run of equal distances as far as possible
+		double step = mEnergy[i+1] - mEnergy[i];
+		double tolerance = 1e-9 * std::fabs(step);
+		int last = i + 1;
+		while (last + 1 < mSize &&
+		       std::fabs(mEnergy[last+1] - mEnergy[last] - step) <= tolerance)
+		{
+			last++;
+		}
+		if (last - i + 1 >= MIN_SEGMENT_SIZE && step > 0.0) {
+			Segment s = { i, last - i + 1, step };
+			mSegments.push_back(s);
+			mSegmentStart.push_back(mEnergy[i]);
+			mSegmentEnd.push_back(mEnergy[last]);
+			i = last + 1;
+		} else {
+			i++;
+		}
+	}
+}
+
+int
+XrayGrid::lowerBound(double energy) const
+{
+	// the last segment starting at or below the energy
+	int k = int(std::upper_bound(mSegmentStart.begin(), mSegmentStart.end(),
+	                             energy) - mSegmentStart.begin()) - 1;
+	if (k >= 0 && energy <= mSegmentEnd[k])
+	{
+		const Segment& s = mSegments[k];
+		int i = s.first + int(std::ceil((energy - mSegmentStart[k]) / s.step));
+		const int last = s.first + s.count - 1;
+		if (i > last) i = last;
+		// correct rounding errors of the stored energies
+		while (i > s.first && mEnergy[i-1] >= energy) i--;
+		while (i < last && mEnergy[i] < energy) i++;
+		return i;
+	}
+	return int(std::lower_bound(mEnergy, mEnergy + mSize, energy) - mEnergy);
+}
+
+int
+XraySpan::lowerBound(double energy) const
+{
+	if (mGrid) return mGrid->lowerBound(energy);
+	return int(std::lower_bound(mEnergy, mEnergy + mSize, energy) - mEnergy);
+}
+
+XraySpan::Status
+XraySpan::interpolate(double energy, double& fp, double& fpp) const
+{
+	fp = 0.0, fpp = 0.0;
+	if (empty()) return NO_DATA;
+	int next = lowerBound(energy);
+	if (next < mSize && mEnergy[next] == energy) {
+		fp = mFp[next];
+		fpp = mFpp[next];
+		return EXACT;
+	}
+	if (next == 0) return BELOW_RANGE;
+	if (next == mSize) return ABOVE_RANGE;
+	int prev = next - 1;
+	double t = (energy - mEnergy[prev]) / (mEnergy[next] - mEnergy[prev]);
+	if (mCubic) {
+		const double * a = mCubic->fp(prev);
+		const double * b = mCubic->fpp(prev);
+		fp  = mFp[prev]  + t * (a[0] + t * (a[1] + t * a[2]));
+		fpp = mFpp[prev] + t * (b[0] + t * (b[1] + t * b[2]));
+		return INTERPOLATED;
+	}
+	fp  = mFp[prev]  + t * (mFp[next]  - mFp[prev]);
+	fpp = mFpp[prev] + t * (mFpp[next] - mFpp[prev]);
+	return INTERPOLATED;
+}
+
+const double XrayCubic::EDGE_RISE = 0.02;
+
+/// Slope at the first point of a run of intervals by the one-sided 
+/// three-point formula, limited to keep the interpolation monotone.
+/// \param[in] h0 Width of the first interval.
+/// \param[in] h1 Width of the second interval.
+/// \param[in] d0 Secant slope of the first interval.
+/// \param[in] d1 Secant slope of the second interval.
+static double 
+endSlope(double h0, double h1, double d0, double d1)
+{
+	double s = ((2.0*h0 + h1) * d0 - h0 * d1) / (h0 + h1);
+	if (s * d0 <= 0.0) return 0.0;
+	if (d0 * d1 < 0.0 && std::fabs(s) > std::fabs(3.0 * d0)) return 3.0 * d0;
+	return s;
+}
+
+/// Slope at an inner point of a run of intervals: the weighted harmonic
+/// mean of the secant slopes next to it, 0 at a local extremum.
+/// \param[in] h0 Width of the interval below the point.
+/// \param[in] h1 Width of the interval above the point.
+/// \param[in] d0 Secant slope of the interval below.
+/// \param[in] d1 Secant slope of the interval above.
+static double 
+innerSlope(double h0, double h1, double d0, double d1)
+{
+	if (d0 * d1 <= 0.0) return 0.0;
+	double w0 = 2.0*h1 + h0;
+	double w1 = h1 + 2.0*h0;
+	return (w0 + w1) / (w0 / d0 + w1 / d1);
+}
+
+void 
+XrayCubic::build(const XraySpan& span)
+{
+	clear();
+	const int n = span.size();
+	if (n < 2) return;
+	const double * f2 = span.fpps();
+	for (int k = 0; k + 1 < n; k++) {
+		if (f2[k+1] - f2[k] > EDGE_RISE * std::fabs(f2[k])) {
+			mEdges.push_back(k);
+		}
+	}
+	buildFactor(span.energies(), span.fps(), n, mFp);
+	buildFactor(span.energies(), f2, n, mFpp);
+}
+
+void 
+XrayCubic::buildFactor(const double * energies, const double * values,
+                       int size, std::vector<double>& coefficients) const
+{
+	coefficients.resize(3 * (size - 1));
+	std::vector<int>::const_iterator edge = mEdges.begin();
+	int first = 0; // first point of the current run
+	while (first + 1 < size)
+	{
+		// the run ends at the next edge or at the last point
+		int last = size - 1;
+		if (edge != mEdges.end()) last = *edge;
+		if (last == first) {
+			// linear across the edge
+			double * c = &coefficients[3*first];
+			c[0] = values[first+1] - values[first];
+			c[1] = c[2] = 0.0;
+			++edge;
+			first++;
+			continue;
+		}
+		// slopes of the points first ... last
+		double slope = 0.0, nextSlope = 0.0;
+		for (int k = first; k < last; k++)
+		{
+			double h = energies[k+1] - energies[k];
+			double d = (values[k+1] - values[k]) / h;
+			if (last - first == 1) {
+				slope = nextSlope = d;
+			} else if (k + 1 == last) {
+				double hp = energies[k] - energies[k-1];
+				double dp = (values[k] - values[k-1]) / hp;
+				nextSlope = endSlope(h, hp, d, dp);
+			} else {
+				double hn = energies[k+2] - energies[k+1];
+				double dn = (values[k+2] - values[k+1]) / hn;
+				if (k == first) slope = endSlope(h, hn, d, dn);
+				nextSlope = innerSlope(h, hn, d, dn);
+			}
+			double delta = values[k+1] - values[k];
+			double * c = &coefficients[3*k];
+			c[0] = h * slope;
+			c[1] = 3.0 * delta - 2.0 * h * slope - h * nextSlope;
+			c[2] = h * slope + h * nextSlope - 2.0 * delta;
+			slope = nextSlope;
+		}
+		first = last;
+	}
+}
+
+void 
+XrayCubic::clear()
+{
+	mFp.clear();
+	mFpp.clear();
+	mEdges.clear();
+}
+
+int
+XraySpan::find(double energy) const
+{
+	int i = lowerBound(energy);
+	if (i < mSize && mEnergy[i] == energy) return i;
+	return -1;
+}
+
+bool
+XrayTable::add(double energy, double fp, double fpp)
+{
+	if (mEnergy.empty() || mEnergy.back() < energy) {
+		mEnergy.push_back(energy);
+		mFp.push_back(fp);
+		mFpp.push_back(fpp);
+		return false;
+	}
+	int i = span().lowerBound(energy);
+	if (mEnergy[i] == energy) {
+		mFp[i] = fp;
+		mFpp[i] = fpp;
+		return true;
+	}
+	mEnergy.insert(mEnergy.begin() + i, energy);
+	mFp.insert(mFp.begin() + i, fp);
+	mFpp.insert(mFpp.begin() + i, fpp);
+	return false;
+}
+
+void
+XrayTable::reserve(int size)
+{
+	mEnergy.reserve(size);
+	mFp.reserve(size);
+	mFpp.reserve(size);
+}
+
+void
+XrayTable::clear()
+{
+	mEnergy.clear();
+	mFp.clear();
+	mFpp.clear();
+}
+
+void
+XrayTable::releaseEnergies()
+{
+	std::vector<double>().swap(mEnergy);
+}
+
+void
+XrayTable::swap(XrayTable& other)
+{
+	mEnergy.swap(other.mEnergy);
+	mFp.swap(other.mFp);
+	mFpp.swap(other.mFpp);
+}
+
+XraySpan
+XrayTable::span() const
+{
+	if (mEnergy.empty()) return XraySpan();
+	return XraySpan(&mEnergy[0], &mFp[0], &mFpp[0], size());
+}
+
+XrayGridPool::~XrayGridPool()
+{
+	foreach(XrayGrid * grid, mGrids) {
+		delete grid;
+	}
+}
+
+const XrayGrid *
+XrayGridPool::intern(const double * energies, int size, bool copy)
+{
+	const QByteArray key(QByteArray::fromRawData(
+		reinterpret_cast<const char *>(energies), size * int(sizeof(double))));
+	const uint hash = qHash(key);
+
+	QMutexLocker lock(&mMutex);
+	QMultiHash<uint, XrayGrid *>::const_iterator it = mGrids.constFind(hash);
+	for(; it != mGrids.constEnd() && it.key() == hash; it++) {
+		const XrayGrid * grid = it.value();
+		if (grid->size() == size &&
+		    std::equal(energies, energies + size, grid->energies()))
+		{
+			return grid;
+		}
+	}
+	if (copy) {
+		mEnergy.push_back(std::vector<double>(energies, energies + size));
+		energies = &mEnergy.back()[0];
+	}
+	XrayGrid * grid = new XrayGrid(energies, size);
+	mGrids.insert(hash, grid);
+	return grid;
+}
+
+int
+XrayGridPool::size() const
+{
+	QMutexLocker lock(&mMutex);
+	return mGrids.size();
+}
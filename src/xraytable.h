@@ -0,0 +1,288 @@
+/*
+ * src/xraytable.h
+ *
+ * Copyright (c) 2010-2011, Ingo Bressler (qsldcalc at ingobressler.net)
+ * Copyright (c) 2009 Technische Universität Berlin,
+ * Stranski-Laboratory for Physical und Theoretical Chemistry
+ *
+ * This file is part of qSLDcalc.
+ *
+ * qSLDcalc is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * qSLDcalc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with qSLDcalc. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EDB_XRAYTABLE_H
+#define EDB_XRAYTABLE_H
+
+#include <vector>
+#include <list>
+#include <QMultiHash>
+#include <QMutex>
+
+/**
+ * Energy grid of X-Ray scattering factors, strictly increasing. It is
+ * shared by all elements with identical energy values, see XrayGridPool.
+ *
+ * Most grids consist of runs of equidistant energies. Within such a
+ * uniform segment, the index of an energy is computed arithmetically
+ * instead of searched.
+ */
+class XrayGrid
+{
+public:
+	/// Creates a grid of existing energy values, which have to outlive
+	/// it, and detects its uniform segments.
+	XrayGrid(const double * energies, int size);
+
+	const double * energies() const { return mEnergy; } //!< All energies.
+	int size() const { return mSize; }                  //!< Number of energies.
+
+	/// Returns the index of the first energy which is not less than the
+	/// specified one, or size() if all energies are less.
+	int lowerBound(double energy) const;
+private:
+	/// Minimum number of energies of a uniform segment.
+	static const int MIN_SEGMENT_SIZE = 4;
+
+	/// A run of equidistant energies.
+	struct Segment {
+		int    first; //!< Index of the first energy.
+		int    count; //!< Number of energies.
+		double step;  //!< Distance of neighbouring energies.
+	};
+	const double *       mEnergy;       //!< Energies.
+	int                  mSize;         //!< Number of energies.
+	std::vector<double>  mSegmentStart; //!< First energy of each segment.
+	std::vector<double>  mSegmentEnd;   //!< Last energy of each segment.
+	std::vector<Segment> mSegments;     //!< All uniform segments.
+};
+
+class XrayCubic;
+
+/**
+ * Read-only view of X-Ray scattering factors: three arrays of the same
+ * length for the energy \f$ E \f$, \f$ f'(E) \f$ and \f$ f''(E) \f$,
+ * sorted by strictly increasing energy. It does not own the data. The
+ * energies may be those of a shared XrayGrid. Precomputed coefficients
+ * for a cubic interpolation may be attached, see XrayCubic.
+ * \sa XrayTable, Element::xrayCoefficients()
+ */
+class XraySpan
+{
+public:
+	/// Outcome of interpolate().
+	typedef enum {
+		EXACT,        //!< The energy is tabulated.
+		INTERPOLATED, //!< Interpolated between two tabulated energies.
+		BELOW_RANGE,  //!< The energy is below all tabulated energies.
+		ABOVE_RANGE,  //!< The energy is above all tabulated energies.
+		NO_DATA       //!< There are no scattering factors.
+	} Status;
+public:
+	/// Creates an empty view.
+	XraySpan()
+		: mEnergy(0), mFp(0), mFpp(0), mSize(0), mGrid(0), mCubic(0)
+	{}
+
+	/// Creates a view of existing arrays with \e size entries each.
+	XraySpan(const double * energy, const double * fp, const double * fpp,
+	         int size)
+		: mEnergy(energy), mFp(fp), mFpp(fpp), mSize(size), mGrid(0),
+		  mCubic(0)
+	{}
+
+	/// Creates a view of factors for the energies of a shared grid.
+	XraySpan(const XrayGrid * grid, const double * fp, const double * fpp)
+		: mEnergy(grid->energies()), mFp(fp), mFpp(fpp),
+		  mSize(grid->size()), mGrid(grid), mCubic(0)
+	{}
+
+	int size() const { return mSize; }        //!< Number of triples.
+	bool empty() const { return mSize <= 0; } //!< True without triples.
+
+	double energy(int i) const { return mEnergy[i]; } //!< i-th energy.
+	double fp(int i) const { return mFp[i]; }         //!< i-th f'.
+	double fpp(int i) const { return mFpp[i]; }       //!< i-th f''.
+
+	const double * energies() const { return mEnergy; } //!< All energies.
+	const double * fps() const { return mFp; }          //!< All f'.
+	const double * fpps() const { return mFpp; }        //!< All f''.
+
+	/// The shared energy grid, NULL if the energies are not shared.
+	const XrayGrid * grid() const { return mGrid; }
+
+	/// Coefficients of the cubic interpolation, NULL if the factors are
+	/// interpolated linearly.
+	const XrayCubic * cubic() const { return mCubic; }
+
+	/// Attaches coefficients of the cubic interpolation.
+	/// \param[in] cubic Built from the factors of this view by 
+	///            XrayCubic::build(), it has to outlive the view. NULL 
+	///            for linear interpolation.
+	void setCubic(const XrayCubic * cubic) { mCubic = cubic; }
+
+	/// Searches the first energy which is not less than the specified
+	/// one. Uses the segments of a shared grid, binary search otherwise.
+	/// \returns Its index or size() if all energies are less.
+	int lowerBound(double energy) const;
+
+	/// Searches for an exact energy value.
+	/// \returns Its index or -1 if there is no such energy.
+	int find(double energy) const;
+
+	/// Determines the scattering factors at the specified energy by
+	/// interpolation between the neighbouring tabulated energies: by
+	/// a single cubic polynomial if coefficients are attached, see 
+	/// cubic(), linearly otherwise. Does not modify anything.
+	/// \param[in] energy Energy in eV.
+	/// \param[out] fp \f$ f'(E) \f$, 0 if the energy is out of range.
+	/// \param[out] fpp \f$ f''(E) \f$, 0 if the energy is out of range.
+	/// \returns EXACT or INTERPOLATED on success.
+	Status interpolate(double energy, double& fp, double& fpp) const;
+private:
+	const double * mEnergy; //!< Energies.
+	const double * mFp;     //!< Real parts \f$ f' \f$.
+	const double * mFpp;    //!< Imaginary parts \f$ f'' \f$.
+	int            mSize;   //!< Length of each array.
+	const XrayGrid * mGrid; //!< Shared energy grid or NULL.
+	const XrayCubic * mCubic; //!< Interpolation coefficients or NULL.
+};
+
+/**
+ * Coefficients of a piecewise cubic interpolation of X-Ray scattering
+ * factors, precomputed once when the factors are loaded, see 
+ * Element::xrayCoefficients().
+ *
+ * \f$ f''(E) \f$ decreases with the energy except at absorption edges, 
+ * where it jumps up. An interval in which it rises by more than 
+ * EDGE_RISE relative to its value at the lower energy is taken as an
+ * edge and interpolated linearly. The runs of intervals between edges 
+ * are interpolated by monotone cubic Hermite polynomials with slopes 
+ * as by Fritsch and Carlson: they do not overshoot the tabulated 
+ * values and never use values from the other side of an edge. Both
+ * \f$ f' \f$ and \f$ f'' \f$ are split at the same edges.
+ *
+ * Within interval \e k from \f$ E_k \f$ to \f$ E_{k+1} \f$, a 
+ * factor is \f$ y_k + t (c_1 + t (c_2 + t c_3)) \f$ with 
+ * \f$ t = (E - E_k) / (E_{k+1} - E_k) \f$. The coefficients 
+ * \f$ c_1, c_2, c_3 \f$ of an interval are stored consecutively.
+ */
+class XrayCubic
+{
+public:
+	/// Minimum relative rise of \f$ f'' \f$ within an interval which
+	/// marks an absorption edge.
+	static const double EDGE_RISE;
+public:
+	/// Computes the coefficients for all intervals of the specified 
+	/// factors, replaces the previous ones. Empty for less than two
+	/// factors.
+	void build(const XraySpan& span);
+
+	/// Removes all coefficients.
+	void clear();
+
+	/// True without coefficients.
+	bool empty() const { return mFp.empty(); }
+
+	/// Number of intervals, one less than the number of factors.
+	int size() const { return int(mFp.size() / 3); }
+
+	/// The coefficients of \f$ f' \f$ within interval \e k.
+	const double * fp(int k) const { return &mFp[3*k]; }
+	/// The coefficients of \f$ f'' \f$ within interval \e k.
+	const double * fpp(int k) const { return &mFpp[3*k]; }
+
+	/// Indices of all intervals detected as absorption edges, sorted.
+	const std::vector<int>& edges() const { return mEdges; }
+private:
+	/// Computes the coefficients of a single factor for all intervals.
+	/// \param[in] energies Tabulated energies.
+	/// \param[in] values Tabulated values of the factor.
+	/// \param[in] size Number of energies and values.
+	/// \param[out] coefficients Receives three per interval.
+	void buildFactor(const double * energies, const double * values, 
+	                 int size, std::vector<double>& coefficients) const;
+private:
+	std::vector<double> mFp;    //!< Coefficients of \f$ f' \f$.
+	std::vector<double> mFpp;   //!< Coefficients of \f$ f'' \f$.
+	std::vector<int>    mEdges; //!< See edges().
+};
+
+/**
+ * Container of X-Ray scattering factors, stored as contiguous arrays
+ * (structure of arrays) sorted by energy.
+ */
+class XrayTable
+{
+public:
+	/// Adds a new triple. Overwrites an existing triple with the same
+	/// energy. Adding in order of increasing energy, as the data files
+	/// are, takes constant time.
+	/// \returns True if an existing triple was overwritten.
+	bool add(double energy, double fp, double fpp);
+
+	/// Reserves memory for \e size triples.
+	void reserve(int size);
+
+	/// Removes all triples.
+	void clear();
+
+	/// Frees the energy values after they were moved to a shared grid.
+	/// Only the f' and f'' arrays remain, for a view by
+	/// XraySpan(const XrayGrid *, const double *, const double *).
+	/// The table has to be cleared before it is modified again.
+	void releaseEnergies();
+
+	/// Exchanges the contents with another table.
+	void swap(XrayTable& other);
+
+	/// Number of triples.
+	int size() const { return int(mEnergy.size()); }
+
+	/// Returns a view of all triples. It becomes invalid on the next
+	/// modification of this table.
+	XraySpan span() const;
+private:
+	std::vector<double> mEnergy; //!< Energies, sorted.
+	std::vector<double> mFp;     //!< Real parts \f$ f' \f$.
+	std::vector<double> mFpp;    //!< Imaginary parts \f$ f'' \f$.
+};
+
+/**
+ * Stores each distinct energy grid once, for all elements. Identical
+ * grids are detected by their content. Safe to use from several threads.
+ */
+class XrayGridPool
+{
+public:
+	~XrayGridPool(); //!< Frees all grids.
+
+	/// Returns the shared grid with the specified energy values. A new
+	/// grid is created if there is none yet.
+	/// \param[in] energies Energy values, strictly increasing.
+	/// \param[in] size Number of energy values.
+	/// \param[in] copy If false, a new grid refers to the energy values
+	///            which have to outlive the pool, e.g. static data.
+	///            Otherwise, they are copied.
+	const XrayGrid * intern(const double * energies, int size, bool copy);
+
+	/// Number of distinct grids.
+	int size() const;
+private:
+	QMultiHash<uint, XrayGrid *>     mGrids;  //!< Grids by content hash.
+	std::list< std::vector<double> > mEnergy; //!< Copied energy values.
+	mutable QMutex                   mMutex;  //!< Serializes access.
+};
+
+#endif